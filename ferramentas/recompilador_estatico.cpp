@@ -0,0 +1,406 @@
+/* recompilador_estatico.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Ferramenta que compila antecipadamente a ROM PRG de um cartucho NROM para C++.
+// O arquivo gerado define um 'ProgramaEstatico' que deve ser compilado junto com
+// o front-end e passado para 'Cpu::set_programa_estatico' depois de carregar a ROM.
+//
+// uso: nesbrasa-recompilar <rom.nes> <saida.cpp> [nome do programa]
+
+#include <cstdlib>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nesbrasa.hpp"
+#include "blocos.hpp"
+#include "estatico.hpp"
+#include "instrucao.hpp"
+#include "recompilador.hpp"
+
+using namespace nesbrasa::nucleo;
+using namespace nesbrasa::tipos;
+using std::map;
+using std::string;
+using std::vector;
+using std::ostream;
+using std::stringstream;
+using std::runtime_error;
+using std::make_unique;
+
+//! Bloco encontrado a partir dos vetores de interrupção
+struct BlocoRecuperado
+{
+    const Bloco* bloco;
+    size_t instrucoes; // tamanho do prefixo que pode ser compilado
+    uint32 ciclos_maximo;
+};
+
+static string hex(uint32 valor, int digitos)
+{
+    stringstream ss;
+    ss << "0x" << std::uppercase << std::hex << std::setw(digitos) << std::setfill('0') << valor;
+    return ss.str();
+}
+
+static string nome_funcao(uint16 inicio)
+{
+    stringstream ss;
+    ss << "bloco_" << std::uppercase << std::hex << std::setw(4) << std::setfill('0') << inicio;
+    return ss.str();
+}
+
+//! Cria um identificador de C++ válido a partir do nome do arquivo da ROM
+static string nome_programa(const string& caminho)
+{
+    string nome = caminho.substr(caminho.find_last_of("/\\") + 1);
+    nome = nome.substr(0, nome.find_last_of('.'));
+
+    for (char& c : nome)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(c)))
+        {
+            c = '_';
+        }
+    }
+
+    return "programa_" + nome;
+}
+
+/*! Percorre o fluxo do programa a partir dos vetores de interrupção, seguindo os branches, 
+    os saltos e as chamadas de sub-rotinas. Os saltos indiretos só são seguidos quando o 
+    endereço de destino está guardado na ROM PRG, os outros ficam para o interpretador
+*/
+static map<uint16, const Bloco*> recuperar_blocos(Nes& nes, BlocoCache& cache, vector<uint16>& nao_resolvidos)
+{
+    map<uint16, const Bloco*> blocos;
+    vector<uint16> pendentes = {
+        nes.memoria.ler_16_bits(0xFFFA), // NMI
+        nes.memoria.ler_16_bits(0xFFFC), // reset
+        nes.memoria.ler_16_bits(0xFFFE), // IRQ e BRK
+    };
+
+    while (!pendentes.empty())
+    {
+        const uint16 pc = pendentes.back();
+        pendentes.pop_back();
+
+        if (pc < 0x8000 || blocos.count(pc) > 0)
+        {
+            continue;
+        }
+
+        const Bloco* bloco = cache.buscar(pc);
+        if (bloco == nullptr || bloco->instrucoes.empty())
+        {
+            continue;
+        }
+        blocos[pc] = bloco;
+
+        const BlocoInstrucao& ultima = bloco->instrucoes.back();
+        const Instrucao& instrucao = tabela_instrucoes[ultima.opcode];
+
+        if (!instrucao.is_desvio())
+        {
+            // o bloco terminou por causa do tamanho máximo
+            pendentes.push_back(bloco->fim);
+        }
+        else if (instrucao.modo == InstrucaoModo::REL)
+        {
+            const int8_t deslocamento = static_cast<int8_t>(ultima.operando);
+            pendentes.push_back(static_cast<uint16>(bloco->fim + deslocamento));
+            pendentes.push_back(bloco->fim);
+        }
+        else if (instrucao.nome == "JMP" && instrucao.modo == InstrucaoModo::ABS)
+        {
+            pendentes.push_back(ultima.operando);
+        }
+        else if (instrucao.nome == "JSR")
+        {
+            pendentes.push_back(ultima.operando);
+            pendentes.push_back(bloco->fim);
+        }
+        else if (instrucao.nome == "JMP" && instrucao.modo == InstrucaoModo::IND)
+        {
+            // só o ponteiro guardado na ROM PRG é constante
+            if (ultima.operando >= 0x8000)
+            {
+                pendentes.push_back(nes.memoria.ler_16_bits_bug(ultima.operando));
+            }
+            else
+            {
+                nao_resolvidos.push_back(ultima.pc);
+            }
+        }
+    }
+
+    return blocos;
+}
+
+//! Calcula o maior prefixo do bloco que pode ser executado sem avançar a ppu
+static BlocoRecuperado calcular_prefixo(const Bloco* bloco)
+{
+    BlocoRecuperado recuperado = { bloco, 0, 0 };
+
+    for (const auto& bloco_instrucao : bloco->instrucoes)
+    {
+        if (!Recompilador::is_traduzivel(bloco_instrucao))
+        {
+            break;
+        }
+
+        recuperado.ciclos_maximo += Recompilador::ciclos_maximo(bloco_instrucao);
+        recuperado.instrucoes++;
+    }
+
+    return recuperado;
+}
+
+/*! Gera o código de uma instrução simples diretamente em C++, como o recompilador dinâmico faz.
+    \return false caso a instrução precise chamar a implementação da tabela
+*/
+static bool emitir_instrucao(ostream& saida, const BlocoInstrucao& bloco_instrucao)
+{
+    const string valor = hex(bloco_instrucao.operando & 0xFF, 2);
+
+    auto carregar = [&](const string& registrador)
+    {
+        saida << "    cpu->" << registrador << " = " << valor << ";\n";
+        saida << "    cpu->set_nz(" << valor << ");\n";
+    };
+
+    auto transferir = [&](const string& origem, const string& destino, bool flags)
+    {
+        saida << "    cpu->" << destino << " = cpu->" << origem << ";\n";
+        if (flags)
+        {
+            saida << "    cpu->set_nz(cpu->" << destino << ");\n";
+        }
+    };
+
+    auto incrementar = [&](const string& registrador, const string& operador)
+    {
+        saida << "    cpu->" << registrador << operador << ";\n";
+        saida << "    cpu->set_nz(cpu->" << registrador << ");\n";
+    };
+
+    auto flag = [&](const string& nome, bool ativa)
+    {
+        saida << "    cpu->" << nome << " = " << (ativa ? "true" : "false") << ";\n";
+    };
+
+    switch (bloco_instrucao.opcode)
+    {
+        case 0xA9: carregar("a"); return true; // LDA #
+        case 0xA2: carregar("x"); return true; // LDX #
+        case 0xA0: carregar("y"); return true; // LDY #
+
+        case 0xAA: transferir("a", "x", true); return true;   // TAX
+        case 0xA8: transferir("a", "y", true); return true;   // TAY
+        case 0x8A: transferir("x", "a", true); return true;   // TXA
+        case 0x98: transferir("y", "a", true); return true;   // TYA
+        case 0xBA: transferir("sp", "x", true); return true;  // TSX
+        case 0x9A: transferir("x", "sp", false); return true; // TXS
+
+        case 0xE8: incrementar("x", "++"); return true; // INX
+        case 0xC8: incrementar("y", "++"); return true; // INY
+        case 0xCA: incrementar("x", "--"); return true; // DEX
+        case 0x88: incrementar("y", "--"); return true; // DEY
+
+        case 0x18: flag("c", false); return true; // CLC
+        case 0x38: flag("c", true); return true;  // SEC
+        case 0x58: flag("i", false); return true; // CLI
+        case 0x78: flag("i", true); return true;  // SEI
+        case 0xD8: flag("d", false); return true; // CLD
+        case 0xF8: flag("d", true); return true;  // SED
+        case 0xB8: flag("v", false); return true; // CLV
+
+        case 0xEA: return true; // NOP
+
+        default:
+            return false;
+    }
+}
+
+static void emitir_bloco(ostream& saida, const BlocoRecuperado& recuperado)
+{
+    const Bloco* bloco = recuperado.bloco;
+
+    saida << "uint32 " << nome_funcao(bloco->inicio) << "(Cpu* cpu)\n";
+    saida << "{\n";
+    saida << "    uint32 ciclos = 0;\n";
+
+    // as instruções chamadas atualizam o pc sozinhas, as geradas em C++ não
+    bool pc_atualizado = true;
+    uint32 ciclos_fixos = 0;
+
+    for (size_t i = 0; i < recuperado.instrucoes; i++)
+    {
+        const BlocoInstrucao& bloco_instrucao = bloco->instrucoes.at(i);
+        const Instrucao& instrucao = tabela_instrucoes[bloco_instrucao.opcode];
+
+        saida << "    // " << hex(bloco_instrucao.pc, 4) << ": " << instrucao.nome << "\n";
+
+        if (emitir_instrucao(saida, bloco_instrucao))
+        {
+            ciclos_fixos += instrucao.ciclos;
+            pc_atualizado = false;
+            continue;
+        }
+
+        if (!pc_atualizado)
+        {
+            saida << "    cpu->pc = " << hex(bloco_instrucao.pc, 4) << ";\n";
+        }
+        saida << "    ciclos += tabela_instrucoes_predecodificadas[" << hex(bloco_instrucao.opcode, 2) << "]";
+        saida << "(cpu, " << hex(bloco_instrucao.operando, 4) << ");\n";
+        pc_atualizado = true;
+    }
+
+    if (!pc_atualizado)
+    {
+        const BlocoInstrucao& ultima = bloco->instrucoes.at(recuperado.instrucoes - 1);
+        const uint16 pc = ultima.pc + tabela_instrucoes[ultima.opcode].bytes;
+
+        saida << "    cpu->pc = " << hex(pc, 4) << ";\n";
+        saida << "    cpu->is_pag_alterada = false;\n";
+    }
+
+    saida << "    return ciclos + " << ciclos_fixos << ";\n";
+    saida << "}\n\n";
+}
+
+static void emitir_programa(ostream& saida, const string& rom, const string& nome, uint32 prg_hash,
+                            const vector<BlocoRecuperado>& blocos, const vector<uint16>& nao_resolvidos)
+{
+    saida << "// Gerado pelo nesbrasa-recompilar a partir de '" << rom << "', não edite este arquivo\n";
+    saida << "\n";
+    saida << "#include \"cpu.hpp\"\n";
+    saida << "#include \"estatico.hpp\"\n";
+    saida << "#include \"instrucao.hpp\"\n";
+    saida << "\n";
+
+    if (!nao_resolvidos.empty())
+    {
+        saida << "// saltos indiretos não resolvidos, os destinos são interpretados:\n";
+        for (uint16 pc : nao_resolvidos)
+        {
+            saida << "//   " << hex(pc, 4) << "\n";
+        }
+        saida << "\n";
+    }
+
+    saida << "namespace\n";
+    saida << "{\n";
+    saida << "using namespace nesbrasa::nucleo;\n";
+    saida << "using namespace nesbrasa::tipos;\n";
+    saida << "\n";
+
+    for (const auto& recuperado : blocos)
+    {
+        emitir_bloco(saida, recuperado);
+    }
+
+    saida << "const BlocoEstatico blocos[] = {\n";
+    for (const auto& recuperado : blocos)
+    {
+        const uint16 inicio = recuperado.bloco->inicio;
+        saida << "    { " << hex(inicio, 4) << ", " << recuperado.instrucoes << ", ";
+        saida << recuperado.ciclos_maximo << ", " << nome_funcao(inicio) << " },\n";
+    }
+    saida << "};\n";
+    saida << "}\n";
+    saida << "\n";
+    saida << "namespace nesbrasa::nucleo\n";
+    saida << "{\n";
+    saida << "    extern const ProgramaEstatico " << nome << ";\n";
+    saida << "    const ProgramaEstatico " << nome << " = {\n";
+    saida << "        " << hex(prg_hash, 8) << ", blocos, sizeof(blocos) / sizeof(blocos[0])\n";
+    saida << "    };\n";
+    saida << "}\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "uso: " << argv[0] << " <rom.nes> <saida.cpp> [nome do programa]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const string rom = argv[1];
+    const string nome = (argc == 4) ? argv[3] : nome_programa(rom);
+
+    try
+    {
+        std::ifstream arquivo_rom(rom, std::ios::binary);
+        if (!arquivo_rom)
+        {
+            throw runtime_error("Erro: não foi possível abrir o arquivo '" + rom + "'");
+        }
+        vector<byte> arquivo((std::istreambuf_iterator<char>(arquivo_rom)), std::istreambuf_iterator<char>());
+
+        auto nes = make_unique<Nes>();
+        nes->carregar_rom(arquivo);
+
+        // a ROM PRG dos outros mapeadores pode ser trocada durante a execução
+        if (nes->cartucho->get_nome() != "NROM")
+        {
+            throw runtime_error("Erro: apenas cartuchos NROM podem ser compilados");
+        }
+
+        BlocoCache cache(&nes->memoria);
+        vector<uint16> nao_resolvidos;
+        const auto encontrados = recuperar_blocos(*nes, cache, nao_resolvidos);
+
+        vector<BlocoRecuperado> blocos;
+        for (const auto& [inicio, bloco] : encontrados)
+        {
+            BlocoRecuperado recuperado = calcular_prefixo(bloco);
+            if (recuperado.instrucoes > 0)
+            {
+                blocos.push_back(recuperado);
+            }
+        }
+
+        std::ofstream saida(argv[2]);
+        if (!saida)
+        {
+            throw runtime_error("Erro: não foi possível criar o arquivo '" + string(argv[2]) + "'");
+        }
+        emitir_programa(saida, rom, nome, calcular_hash_prg(&nes->memoria), blocos, nao_resolvidos);
+
+        std::cout << encontrados.size() << " blocos encontrados, " << blocos.size() << " compilados, ";
+        std::cout << nao_resolvidos.size() << " saltos indiretos não resolvidos" << std::endl;
+    }
+    catch (const std::exception& erro)
+    {
+        std::cerr << erro.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
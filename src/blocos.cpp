@@ -0,0 +1,257 @@
+/* blocos.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blocos.hpp"
+#include "memoria.hpp"
+
+namespace nesbrasa::nucleo
+{
+    BlocoCache::BlocoCache(Memoria* memoria):
+        memoria(memoria)
+    {
+    }
+
+    const Bloco* BlocoCache::buscar(uint16 pc)
+    {
+        if (!BlocoCache::is_endereco_cacheavel(pc))
+        {
+            return nullptr;
+        }
+
+        auto& blocos = (pc <= 0x07FF) ? this->blocos_ram : this->blocos_rom;
+
+        auto iterador = blocos.find(pc);
+        if (iterador != blocos.end())
+        {
+            return &iterador->second;
+        }
+
+        auto& bloco = blocos.emplace(pc, this->decodificar(pc)).first->second;
+        if (pc <= 0x07FF)
+        {
+            this->marcar_ram();
+        }
+
+        return &bloco;
+    }
+
+    bool BlocoCache::invalidar_ram(uint16 endereco)
+    {
+        endereco %= 0x0800;
+        const size_t quantidade = this->blocos_ram.size();
+
+        for (auto iterador = this->blocos_ram.begin(); iterador != this->blocos_ram.end();)
+        {
+            const Bloco& bloco = iterador->second;
+            if (endereco >= bloco.inicio && endereco < bloco.fim)
+            {
+                iterador = this->blocos_ram.erase(iterador);
+            }
+            else
+            {
+                iterador++;
+            }
+        }
+
+        if (this->blocos_ram.size() == quantidade)
+        {
+            return false;
+        }
+
+        this->marcar_ram();
+        return true;
+    }
+
+    void BlocoCache::limpar()
+    {
+        this->blocos_rom.clear();
+        this->blocos_ram.clear();
+        this->memoria->limpar_ram_codigo();
+    }
+
+    void BlocoCache::descartar_nativo()
+    {
+        // apenas os blocos da ROM PRG são traduzidos
+        for (auto& [inicio, bloco] : this->blocos_rom)
+        {
+            bloco.execucoes = 0;
+            bloco.is_traduzido = false;
+            bloco.nativo = nullptr;
+            bloco.nativo_instrucoes = 0;
+            bloco.nativo_ciclos_maximo = 0;
+        }
+    }
+
+    bool BlocoCache::is_endereco_cacheavel(uint16 endereco)
+    {
+        return endereco <= 0x07FF || endereco >= 0x8000;
+    }
+
+    Bloco BlocoCache::decodificar(uint16 pc)
+    {
+        Bloco bloco;
+        bloco.inicio = pc;
+        bloco.fim = pc;
+        bloco.ciclos = 0;
+        bloco.execucoes = 0;
+        bloco.is_traduzido = false;
+        bloco.nativo = nullptr;
+        bloco.nativo_instrucoes = 0;
+        bloco.nativo_ciclos_maximo = 0;
+
+        // o bloco não pode sair da área em que começou
+        const uint32 limite = (pc <= 0x07FF) ? 0x0800 : 0x10000;
+        uint32 endereco = pc;
+
+        while (bloco.instrucoes.size() < BlocoCache::BLOCO_TAMANHO_MAXIMO)
+        {
+            const byte opcode = this->memoria->ler(endereco);
+            const Instrucao& instrucao = tabela_instrucoes[opcode];
+
+            // opcodes inválidos são deixados para o caminho normal da cpu,
+            // que é o responsável por lançar o erro
+            if (!instrucao.is_valida() || endereco + instrucao.bytes > limite)
+            {
+                break;
+            }
+
+            uint16 operando = 0;
+            if (instrucao.bytes == 2)
+            {
+                operando = this->memoria->ler(endereco + 1);
+            }
+            else if (instrucao.bytes == 3)
+            {
+                operando = this->memoria->ler_16_bits(endereco + 1);
+            }
+
+            BlocoInstrucao bloco_instrucao;
+            bloco_instrucao.implementacao = tabela_instrucoes_predecodificadas[opcode];
+            bloco_instrucao.pc = endereco;
+            bloco_instrucao.operando = operando;
+            bloco_instrucao.opcode = opcode;
+            bloco.instrucoes.push_back(bloco_instrucao);
+
+            bloco.ciclos += instrucao.ciclos;
+            endereco += instrucao.bytes;
+            bloco.fim = endereco;
+
+            if (instrucao.is_desvio())
+            {
+                break;
+            }
+        }
+
+        bloco.espera = BlocoEspera::NENHUMA;
+        if (!bloco.instrucoes.empty())
+        {
+            bloco.espera = this->detectar_espera(bloco);
+        }
+
+        return bloco;
+    }
+
+    BlocoEspera BlocoCache::detectar_espera(const Bloco& bloco)
+    {
+        const BlocoInstrucao& ultima = bloco.instrucoes.back();
+        const Instrucao& desvio = tabela_instrucoes[ultima.opcode];
+
+        // JMP *
+        if (bloco.instrucoes.size() == 1 && ultima.opcode == 0x4C && ultima.operando == bloco.inicio)
+        {
+            return BlocoEspera::SALTO;
+        }
+
+        // o laço precisa terminar com um branch para o início do bloco
+        if (desvio.modo != InstrucaoModo::REL)
+        {
+            return BlocoEspera::NENHUMA;
+        }
+
+        uint16 destino = ultima.pc + 2 + ultima.operando;
+        if (ultima.operando >= 0x80)
+        {
+            destino -= 0x100;
+        }
+
+        if (destino != bloco.inicio)
+        {
+            return BlocoEspera::NENHUMA;
+        }
+
+        // as outras instruções só podem ler valores e alterar registradores,
+        // e os endereços lidos precisam ser conhecidos durante a decodificação
+        auto espera = BlocoEspera::RAM;
+        for (size_t i = 0; i < bloco.instrucoes.size() - 1; i++)
+        {
+            const BlocoInstrucao& bloco_instrucao = bloco.instrucoes[i];
+            const Instrucao& instrucao = tabela_instrucoes[bloco_instrucao.opcode];
+
+            const bool somente_leitura = 
+                instrucao.nome == "LDA" || instrucao.nome == "LDX" || instrucao.nome == "LDY" ||
+                instrucao.nome == "BIT" || instrucao.nome == "AND" || instrucao.nome == "ORA" ||
+                instrucao.nome == "EOR" || instrucao.nome == "CMP" || instrucao.nome == "CPX" ||
+                instrucao.nome == "CPY" || instrucao.nome == "NOP";
+
+            if (!somente_leitura)
+            {
+                return BlocoEspera::NENHUMA;
+            }
+
+            switch (instrucao.modo)
+            {
+                case InstrucaoModo::IMPL:
+                case InstrucaoModo::IMED:
+                case InstrucaoModo::P_ZERO:
+                    break;
+
+                case InstrucaoModo::ABS:
+                    if (bloco_instrucao.operando <= 0x1FFF)
+                    {
+                        // RAM ou um dos seus espelhos
+                        break;
+                    }
+                    else if (bloco_instrucao.operando <= 0x3FFF && (bloco_instrucao.operando % 8) == 2)
+                    {
+                        // PPUSTATUS ou um dos seus espelhos
+                        espera = BlocoEspera::PPU_ESTADO;
+                        break;
+                    }
+                    return BlocoEspera::NENHUMA;
+
+                default:
+                    return BlocoEspera::NENHUMA;
+            }
+        }
+
+        return espera;
+    }
+
+    void BlocoCache::marcar_ram()
+    {
+        this->memoria->limpar_ram_codigo();
+
+        for (const auto& [inicio, bloco] : this->blocos_ram)
+        {
+            for (uint32 endereco = bloco.inicio; endereco < bloco.fim; endereco++)
+            {
+                this->memoria->marcar_ram_codigo(endereco);
+            }
+        }
+    }
+}
\ No newline at end of file
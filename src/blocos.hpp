@@ -0,0 +1,130 @@
+/* blocos.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "instrucao.hpp"
+#include "tipos_numeros.hpp"
+
+namespace nesbrasa::nucleo
+{
+    using std::vector;
+    using std::unordered_map;
+    using namespace nesbrasa::tipos;
+
+    class Memoria;
+    class Cpu;
+
+    // Tipo usado para referenciar o código nativo gerado pelo recompilador
+    // para um bloco, que retorna a quantidade de ciclos executados
+    using BlocoNativo = uint32 (*)(Cpu*);
+
+    //! Laços de espera reconhecidos durante a decodificação de um bloco
+    enum class BlocoEspera
+    {
+        NENHUMA,
+        // 'JMP' para o próprio endereço, só termina com uma interrupção
+        SALTO,
+        // lê valores da RAM, que só podem mudar durante uma interrupção
+        RAM,
+        // lê o registrador PPUSTATUS ($2002) esperando uma mudança na ppu
+        PPU_ESTADO,
+    };
+
+    //! Uma instrução de um bloco, com o opcode e o operando já decodificados
+    struct BlocoInstrucao
+    {
+        InstrucaoPredecodificada implementacao;
+
+        uint16 pc;       // endereço do opcode
+        uint16 operando; // operando lido logo após o opcode
+        byte   opcode;
+    };
+
+    /*! Sequência de instruções executadas em linha reta, 
+        terminada pelo próximo branch ou jump */
+    struct Bloco
+    {
+        uint16 inicio; // endereço da primeira instrução
+        uint16 fim;    // endereço logo após o último byte da última instrução
+
+        // soma dos ciclos de todas as instruções, sem contar
+        // os ciclos adicionais de páginas alteradas e de branches
+        uint32 ciclos;
+
+        // indica se o bloco é um laço de espera que só lê valores e desvia para o próprio início
+        BlocoEspera espera;
+
+        vector<BlocoInstrucao> instrucoes;
+
+        // membros usados pelo recompilador, que podem ser alterados mesmo em um bloco constante
+        mutable uint32 execucoes;    // quantidade de vezes que o bloco foi executado antes de ser traduzido
+        mutable bool is_traduzido;
+        mutable BlocoNativo nativo;  // código nativo, nulo caso o bloco não possa ser traduzido
+        mutable size_t nativo_instrucoes;   // quantidade de instruções executadas pelo código nativo
+        mutable uint32 nativo_ciclos_maximo; // quantidade máxima de ciclos que o código nativo pode levar
+    };
+
+    /*! Cache de blocos de instruções já decodificadas, indexado pelo endereço
+        da primeira instrução. Só guarda código executado da RAM interna
+        ($0000-$07FF) e da ROM PRG ($8000-$FFFF) */
+    class BlocoCache
+    {
+    private:
+        Memoria* memoria;
+
+        unordered_map<uint16, Bloco> blocos_rom;
+        unordered_map<uint16, Bloco> blocos_ram;
+
+    public:
+        // quantidade máxima de instruções em um bloco
+        static constexpr size_t BLOCO_TAMANHO_MAXIMO = 32;
+
+        BlocoCache(Memoria* memoria);
+
+        /*! Busca o bloco que começa no endereço, decodificando-o caso ainda não exista.
+            \return O bloco, ou nullptr caso o endereço não possa ser guardado no cache
+        */
+        const Bloco* buscar(uint16 pc);
+
+        /*! Descarta os blocos da RAM que contêm o endereço que acabou de ser escrito
+            \return true caso algum bloco tenha sido descartado
+        */
+        bool invalidar_ram(uint16 endereco);
+
+        //! Descarta todos os blocos
+        void limpar();
+
+        /*! Descarta o código nativo de todos os blocos, que voltam a ser contados para
+            serem traduzidos novamente. Os blocos continuam no cache e os ponteiros para eles
+            continuam válidos */
+        void descartar_nativo();
+
+        //! Checa se o código localizado no endereço pode ser guardado no cache
+        static bool is_endereco_cacheavel(uint16 endereco);
+
+    private:
+        Bloco decodificar(uint16 pc);
+        BlocoEspera detectar_espera(const Bloco& bloco);
+        void marcar_ram();
+    };
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+/* compositor.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include "compositor.hpp"
+
+#if defined(NESBRASA_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace nesbrasa::nucleo::compositor
+{
+    using std::runtime_error;
+    using namespace std::string_literals;
+
+    static const int LINHA_LARGURA = 256;
+
+    // conjunto de instruções usado para compor as próximas linhas
+    static Simd simd_atual = get_simd_disponivel();
+
+#if defined(NESBRASA_SIMD_X86)
+    /*! Compõe 16 pixels, guardando o endereço da paleta de cada um em 'cores'
+        \return Máscara com os pixels em que o sprite 0 sobrepôs o fundo
+    */
+    __attribute__((target("sse2")))
+    static int compor_16_pixels(__m128i fundo, __m128i sprite, byte* cores)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i tres = _mm_set1_epi8(3);
+
+        const __m128i f_transparente = _mm_cmpeq_epi8(_mm_and_si128(fundo, tres), zero);
+        const __m128i s_transparente = _mm_cmpeq_epi8(_mm_and_si128(sprite, tres), zero);
+        const __m128i s_frente = _mm_cmpeq_epi8(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_ATRAS)), zero);
+        const __m128i s_zero = _mm_cmpeq_epi8(_mm_and_si128(sprite, _mm_set1_epi8(static_cast<char>(SPRITE_ZERO))),
+                                              _mm_set1_epi8(static_cast<char>(SPRITE_ZERO)));
+
+        // o sprite aparece quando é opaco e está na frente ou o fundo é transparente
+        const __m128i usar_sprite = _mm_andnot_si128(s_transparente, _mm_or_si128(f_transparente, s_frente));
+        const __m128i cor_sprite = _mm_or_si128(_mm_and_si128(sprite, _mm_set1_epi8(SPRITE_COR)), _mm_set1_epi8(0x10));
+        const __m128i cor_fundo = _mm_andnot_si128(f_transparente, fundo);
+
+        const __m128i cor = _mm_or_si128(_mm_and_si128(usar_sprite, cor_sprite), 
+                                         _mm_andnot_si128(usar_sprite, cor_fundo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(cores), cor);
+
+        const __m128i colisao = _mm_andnot_si128(f_transparente, _mm_andnot_si128(s_transparente, s_zero));
+        return _mm_movemask_epi8(colisao);
+    }
+
+    //! Versão SSE2 de 'compor_cores'
+    __attribute__((target("sse2")))
+    static bool compor_cores_sse2(const byte* fundo, const byte* sprites, byte* cores,
+                                  bool fundo_esquerda, bool sprites_esquerda)
+    {
+        bool sprite_zero = false;
+
+        // os 8 primeiros pixels podem ser escondidos pelas flags de PPUMASK
+        const __m128i esquerda = _mm_set_epi32(-1, -1, 0, 0);
+        const __m128i fundo_mascara = fundo_esquerda ? _mm_set1_epi8(-1) : esquerda;
+        const __m128i sprites_mascara = sprites_esquerda ? _mm_set1_epi8(-1) : esquerda;
+
+        for (int x = 0; x < LINHA_LARGURA; x += 16)
+        {
+            __m128i f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fundo + x));
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sprites + x));
+            if (x == 0)
+            {
+                f = _mm_and_si128(f, fundo_mascara);
+                s = _mm_and_si128(s, sprites_mascara);
+            }
+
+            int colisao = compor_16_pixels(f, s, cores + x);
+            if (x == LINHA_LARGURA - 16)
+            {
+                // o sprite 0 não é detectado no último pixel da linha
+                colisao &= 0x7FFF;
+            }
+            sprite_zero = sprite_zero || colisao != 0;
+        }
+
+        return sprite_zero;
+    }
+
+    //! Converte os endereços da paleta de uma linha para RGB usando AVX2
+    __attribute__((target("avx2")))
+    static void converter_cores_avx2(const byte* cores, const array<uint32, 0x20>& paleta_rgb, uint32* saida)
+    {
+        const int* tabela = reinterpret_cast<const int*>(paleta_rgb.data());
+        for (int x = 0; x < LINHA_LARGURA; x += 16)
+        {
+            const __m128i indices = _mm_load_si128(reinterpret_cast<const __m128i*>(cores + x));
+            const __m256i rgb_1 = _mm256_i32gather_epi32(tabela, _mm256_cvtepu8_epi32(indices), 4);
+            const __m256i rgb_2 = _mm256_i32gather_epi32(tabela, _mm256_cvtepu8_epi32(_mm_srli_si128(indices, 8)), 4);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(saida + x), rgb_1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(saida + x + 8), rgb_2);
+        }
+    }
+#endif
+
+    /*! Compõe os 256 pixels de uma linha, guardando o endereço da paleta de cada um em 'cores'
+        \return true caso o sprite 0 tenha sobreposto um pixel opaco do fundo
+    */
+    static bool compor_cores(const byte* fundo, const byte* sprites, byte* cores,
+                             bool fundo_esquerda, bool sprites_esquerda)
+    {
+#if defined(NESBRASA_SIMD_X86)
+        // o AVX2 também usa a versão SSE2, já que cada linha tem só 256 pixels de 1 byte
+        if (simd_atual != Simd::ESCALAR)
+        {
+            return compor_cores_sse2(fundo, sprites, cores, fundo_esquerda, sprites_esquerda);
+        }
+#endif
+
+        bool sprite_zero = false;
+        for (int x = 0; x < LINHA_LARGURA; x++)
+        {
+            byte f = (x < 8 && !fundo_esquerda) ? 0 : fundo[x];
+            byte s = (x < 8 && !sprites_esquerda) ? 0 : sprites[x];
+
+            bool colisao = false;
+            cores[x] = compor_pixel(f, s, colisao);
+            sprite_zero = sprite_zero || (colisao && x < LINHA_LARGURA - 1);
+        }
+
+        return sprite_zero;
+    }
+
+    void set_simd(Simd simd)
+    {
+        if (!is_simd_suportado(simd))
+        {
+            throw runtime_error("Erro: o processador não suporta o conjunto de instruções do compositor"s);
+        }
+
+        simd_atual = simd;
+    }
+
+    Simd get_simd()
+    {
+        return simd_atual;
+    }
+
+    bool compor_linha(const byte* fundo, const byte* sprites, const array<uint32, 0x20>& paleta_rgb,
+                      uint32* saida, bool fundo_esquerda, bool sprites_esquerda)
+    {
+        alignas(32) byte cores[LINHA_LARGURA];
+        bool sprite_zero = compor_cores(fundo, sprites, cores, fundo_esquerda, sprites_esquerda);
+
+#if defined(NESBRASA_SIMD_X86)
+        if (simd_atual == Simd::AVX2)
+        {
+            converter_cores_avx2(cores, paleta_rgb, saida);
+            return sprite_zero;
+        }
+#endif
+
+        for (int x = 0; x < LINHA_LARGURA; x++)
+        {
+            saida[x] = paleta_rgb[cores[x]];
+        }
+
+        return sprite_zero;
+    }
+
+    bool compor_linha_indices(const byte* fundo, const byte* sprites, const array<uint16, 0x20>& paleta_indices,
+                              uint16* saida, bool fundo_esquerda, bool sprites_esquerda)
+    {
+        alignas(32) byte cores[LINHA_LARGURA];
+        bool sprite_zero = compor_cores(fundo, sprites, cores, fundo_esquerda, sprites_esquerda);
+
+        for (int x = 0; x < LINHA_LARGURA; x++)
+        {
+            saida[x] = paleta_indices[cores[x]];
+        }
+
+        return sprite_zero;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+/* compositor.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+
+#include "simd.hpp"
+#include "tipos_numeros.hpp"
+
+// referencias utilizadas:
+// https://wiki.nesdev.com/w/index.php/PPU_rendering#Preliminary_notes
+// https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+
+namespace nesbrasa::nucleo::compositor
+{
+    using std::array;
+    using namespace nesbrasa::tipos;
+
+    // bits dos pixels de sprites recebidos pelo compositor, a cor usa os bits 0-3
+    const byte SPRITE_COR   = 0x0F;
+    const byte SPRITE_ATRAS = 0x40; // o sprite fica atrás dos pixels opacos do fundo
+    const byte SPRITE_ZERO  = 0x80; // o pixel pertence ao sprite 0 da OAM
+
+    /*! Compõe um pixel de fundo com um pixel de sprite
+        \param fundo Pixel de fundo, com a paleta nos bits 2-3 e a cor nos bits 0-1
+        \param sprite Pixel de sprite, usando os bits 'SPRITE_*'
+        \param sprite_zero Recebe true caso o sprite 0 tenha sobreposto um pixel opaco do fundo
+        \return O endereço na memória das paletas ($00-$1F) da cor resultante
+    */
+    inline byte compor_pixel(byte fundo, byte sprite, bool& sprite_zero)
+    {
+        const bool f = (fundo & 3) != 0;
+        const bool s = (sprite & 3) != 0;
+
+        sprite_zero = f && s && (sprite & SPRITE_ZERO) != 0;
+
+        if (s && (!f || (sprite & SPRITE_ATRAS) == 0))
+        {
+            return (sprite & SPRITE_COR) | 0x10;
+        }
+
+        return f ? fundo : 0;
+    }
+
+    /*! Escolhe o conjunto de instruções usado pelas próximas linhas compostas. O padrão é o
+        mais completo suportado pelo processador, checado durante a execução. Lança uma exceção
+        caso o processador não suporte o conjunto de instruções
+    */
+    void set_simd(Simd simd);
+
+    //! Retorna o conjunto de instruções usado para compor as linhas
+    Simd get_simd();
+
+    /*! Compõe os 256 pixels de uma linha e os converte para RGB, usando
+        o conjunto de instruções escolhido por 'set_simd'
+        \param fundo Pixels de fundo no formato de 'compor_pixel'
+        \param sprites Pixels de sprites no formato de 'compor_pixel'
+        \param paleta_rgb Cor RGB de cada endereço da memória das paletas
+        \param saida Pixels RGB da linha
+        \param fundo_esquerda Exibe o fundo nos 8 primeiros pixels
+        \param sprites_esquerda Exibe os sprites nos 8 primeiros pixels
+        \return true caso o sprite 0 tenha sobreposto um pixel opaco do fundo, 
+                sem contar o último pixel da linha
+    */
+    bool compor_linha(const byte* fundo, const byte* sprites, const array<uint32, 0x20>& paleta_rgb,
+                      uint32* saida, bool fundo_esquerda, bool sprites_esquerda);
+
+    /*! Igual a 'compor_linha', mas guarda o índice da tabela de cores de cada pixel
+        \param paleta_indices Índice de 'cores::tabela_rgb_enfase' de cada endereço da memória das paletas
+        \param saida Índices dos pixels da linha
+    */
+    bool compor_linha_indices(const byte* fundo, const byte* sprites, const array<uint16, 0x20>& paleta_indices,
+                              uint16* saida, bool fundo_esquerda, bool sprites_esquerda);
+}
\ No newline at end of file
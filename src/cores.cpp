@@ -69,4 +69,47 @@ namespace nesbrasa::nucleo::cores
         0x000000, // $3F
         0x000000, // $40
     };
+
+    static array<uint32, 0x200> criar_tabela_rgb_enfase()
+    {
+        // fator aplicado aos componentes que não recebem ênfase
+        const double atenuacao = 0.75;
+
+        array<uint32, 0x200> tabela {};
+        for (uint32 enfase = 0; enfase < 8; enfase++)
+        {
+            for (uint32 cor = 0; cor < 0x40; cor++)
+            {
+                uint32 rgb = tabela_rgb[cor];
+                double r = (rgb >> 16) & 0xFF;
+                double g = (rgb >> 8) & 0xFF;
+                double b = rgb & 0xFF;
+
+                // cada bit de ênfase escurece os outros 2 componentes
+                if (enfase & 1)
+                {
+                    g *= atenuacao;
+                    b *= atenuacao;
+                }
+                if (enfase & 2)
+                {
+                    r *= atenuacao;
+                    b *= atenuacao;
+                }
+                if (enfase & 4)
+                {
+                    r *= atenuacao;
+                    g *= atenuacao;
+                }
+
+                tabela[(enfase << 6) | cor] = (static_cast<uint32>(r) << 16) | 
+                                              (static_cast<uint32>(g) << 8) | 
+                                              static_cast<uint32>(b);
+            }
+        }
+
+        return tabela;
+    }
+
+    array<uint32, 0x200> tabela_rgb_enfase = criar_tabela_rgb_enfase();
 }
\ No newline at end of file
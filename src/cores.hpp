@@ -28,4 +28,10 @@ namespace nesbrasa::nucleo::cores
     using namespace nesbrasa::tipos;
 
     extern array<uint32, 0x40> tabela_rgb;
+
+    /*! As 64 cores de 'tabela_rgb' para cada uma das 8 combinações de ênfase
+        de PPUMASK, no índice (ênfase << 6) | cor. A ênfase usa os bits 5-7 de
+        PPUMASK (vermelho, verde e azul) e escurece os outros componentes
+    */
+    extern array<uint32, 0x200> tabela_rgb_enfase;
 }
\ No newline at end of file
@@ -32,7 +32,8 @@ namespace nesbrasa::nucleo
     using std::runtime_error;
 
     Cpu::Cpu(Memoria* memoria): 
-        instrucoes(carregar_instrucoes()), 
+        blocos(memoria),
+        recompilador(this),
         memoria(memoria)            
     {
         this->ciclos = 0;
@@ -42,18 +43,22 @@ namespace nesbrasa::nucleo
         this->x = 0;
         this->y = 0;
         this->c = false;
-        this->z = false;
+        this->z_valor = 1;
         this->i = false;
         this->d = false;
         this->b = false;
         this->v = false;
-        this->n = false;
+        this->n_valor = 0;
         this->esperar = 0;
         this->is_pag_alterada = false;
         this->interrupcao = Interrupcao::NENHUMA;
+        this->nucleo = CpuNucleo::BLOCOS;
+        this->bloco_atual = nullptr;
+        this->bloco_indice = 0;
+        this->programa_estatico = nullptr;
     }
 
-    uint Cpu::avancar()
+    uint Cpu::avancar(uint32 ciclos_limite)
     {
         if (this->esperar > 0)
         {
@@ -85,10 +90,34 @@ namespace nesbrasa::nucleo
         }
         this->interrupcao = Interrupcao::NENHUMA;
 
+        if (this->nucleo == CpuNucleo::DINAMICO || this->nucleo == CpuNucleo::DIFERENCIAL ||
+            this->nucleo == CpuNucleo::ESTATICO)
+        {
+            // a entrada de uma interrupção já faz parte dos ciclos executados
+            const uint32 executados = this->ciclos - ciclos;
+            if (executados < ciclos_limite && this->executar_nativo(ciclos_limite - executados))
+            {
+                return this->ciclos - ciclos;
+            }
+        }
+
+        if (this->nucleo != CpuNucleo::TABELA && this->nucleo != CpuNucleo::ESPECIALIZADO)
+        {
+            // executar a instrução já decodificada caso o pc esteja em um bloco do cache
+            const BlocoInstrucao* bloco_instrucao = this->buscar_bloco_instrucao();
+            if (bloco_instrucao != nullptr)
+            {
+                this->ciclos += bloco_instrucao->implementacao(this, bloco_instrucao->operando);
+                return this->ciclos - ciclos;
+            }
+        }
+
         byte opcode = this->memoria->ler(this->pc);        
         
+        const Instrucao& instrucao = tabela_instrucoes[opcode];
+        
         // lançar erro se a instrução não existir na tabela
-        if (!this->instrucoes.at(opcode).has_value())
+        if (!instrucao.is_valida())
         {
             stringstream erro_ss;
             erro_ss << "Opcode não reconhecido: ";
@@ -97,19 +126,91 @@ namespace nesbrasa::nucleo
             throw runtime_error(erro_ss.str());
         }
 
-        auto instrucao = this->instrucoes.at(opcode).value();
-        this->executar(&instrucao);
-        
-        this->ciclos += instrucao.ciclos;
-        if (this->is_pag_alterada) 
+        switch (this->nucleo)
         {
-            this->ciclos += instrucao.ciclos_pag_alt;
+            case CpuNucleo::ESPECIALIZADO:
+            case CpuNucleo::BLOCOS:
+            case CpuNucleo::DINAMICO:
+            case CpuNucleo::DIFERENCIAL:
+            case CpuNucleo::ESTATICO:
+                this->ciclos += tabela_instrucoes_especializadas[opcode](this);
+                break;
+
+            default:
+                this->executar(&instrucao);
+                
+                this->ciclos += instrucao.ciclos;
+                if (this->is_pag_alterada) 
+                {
+                    this->ciclos += instrucao.ciclos_pag_alt;
+                }
+                break;
         }
         
         return this->ciclos - ciclos;
     }
 
-    void Cpu::executar(Instrucao* instrucao)
+    uint32 Cpu::executar_ciclos(uint32 ciclos_limite, bool parar_em_lacos)
+    {
+        Ppu& ppu = this->memoria->nes->ppu;
+        const bool nativo = this->nucleo == CpuNucleo::DINAMICO || this->nucleo == CpuNucleo::DIFERENCIAL ||
+                            this->nucleo == CpuNucleo::ESTATICO;
+
+        uint32 executados = 0;
+        while (executados < ciclos_limite)
+        {
+            // as interrupções, as esperas e as instruções fora do cache passam por 'avancar'
+            if (this->esperar > 0 || this->interrupcao != Interrupcao::NENHUMA ||
+                this->nucleo == CpuNucleo::TABELA || this->nucleo == CpuNucleo::ESPECIALIZADO ||
+                !this->posicionar_bloco())
+            {
+                const uint ciclos = this->avancar(ciclos_limite - executados);
+                ppu.adiar_pontos(ciclos * 3);
+                executados += ciclos;
+                continue;
+            }
+
+            // os laços de espera e o código nativo só começam no início de um bloco
+            const Bloco* bloco = this->bloco_atual;
+            if (this->bloco_indice == 0)
+            {
+                if (parar_em_lacos && bloco->espera != BlocoEspera::NENHUMA && executados > 0)
+                {
+                    break;
+                }
+
+                const uint32 inicio = this->ciclos;
+                if (nativo && this->executar_nativo(ciclos_limite - executados))
+                {
+                    ppu.adiar_pontos((this->ciclos - inicio) * 3);
+                    executados += this->ciclos - inicio;
+                    continue;
+                }
+            }
+
+            // executar as instruções seguintes do bloco enquanto o programa não desviar,
+            // as escritas na RAM podem descartar o bloco e limpar 'bloco_atual'
+            do
+            {
+                const BlocoInstrucao& instrucao = bloco->instrucoes[this->bloco_indice];
+                this->bloco_indice += 1;
+
+                // os desvios somam os ciclos extras diretamente em 'ciclos'
+                const uint32 inicio = this->ciclos;
+                this->ciclos += instrucao.implementacao(this, instrucao.operando);
+                ppu.adiar_pontos((this->ciclos - inicio) * 3);
+                executados += this->ciclos - inicio;
+            }
+            while (executados < ciclos_limite && this->interrupcao == Interrupcao::NENHUMA &&
+                   this->esperar == 0 && this->bloco_atual == bloco && 
+                   this->bloco_indice < bloco->instrucoes.size() &&
+                   bloco->instrucoes[this->bloco_indice].pc == this->pc);
+        }
+
+        return executados;
+    }
+
+    void Cpu::executar(const Instrucao* instrucao)
     {
         auto endereco = instrucao->buscar_endereco(this);
         
@@ -117,8 +218,239 @@ namespace nesbrasa::nucleo
         instrucao->implementacao(instrucao, this, endereco);
     }
 
+    const BlocoInstrucao* Cpu::buscar_bloco_instrucao()
+    {
+        if (!this->posicionar_bloco())
+        {
+            return nullptr;
+        }
+
+        const BlocoInstrucao* bloco_instrucao = &this->bloco_atual->instrucoes[this->bloco_indice];
+        this->bloco_indice += 1;
+
+        return bloco_instrucao;
+    }
+
+    bool Cpu::posicionar_bloco()
+    {
+        if (this->bloco_atual != nullptr)
+        {
+            // continuar no bloco atual caso o programa não tenha desviado
+            if (this->bloco_indice < this->bloco_atual->instrucoes.size() &&
+                this->bloco_atual->instrucoes[this->bloco_indice].pc == this->pc)
+            {
+                return true;
+            }
+
+            // o bloco desviou para o próprio início, como em um laço
+            if (this->bloco_atual->inicio == this->pc)
+            {
+                this->bloco_indice = 0;
+                return true;
+            }
+        }
+
+        this->bloco_atual = this->blocos.buscar(this->pc);
+        this->bloco_indice = 0;
+
+        if (this->bloco_atual == nullptr || this->bloco_atual->instrucoes.empty())
+        {
+            this->bloco_atual = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    const Bloco* Cpu::buscar_laco_espera()
+    {
+        if (this->nucleo == CpuNucleo::TABELA || this->nucleo == CpuNucleo::ESPECIALIZADO)
+        {
+            return nullptr;
+        }
+
+        if (this->esperar > 0 || this->interrupcao != Interrupcao::NENHUMA)
+        {
+            return nullptr;
+        }
+
+        if (!this->posicionar_bloco() || this->bloco_indice != 0)
+        {
+            return nullptr;
+        }
+
+        if (this->bloco_atual->espera == BlocoEspera::NENHUMA)
+        {
+            return nullptr;
+        }
+
+        return this->bloco_atual;
+    }
+
+    bool Cpu::executar_nativo(uint32 ciclos_limite)
+    {
+        // o código do núcleo estático é portável, só o recompilador depende da plataforma
+        if (this->nucleo != CpuNucleo::ESTATICO && !Recompilador::is_disponivel())
+        {
+            return false;
+        }
+
+        if (!this->posicionar_bloco() || this->bloco_indice != 0)
+        {
+            return false;
+        }
+
+        // apenas os blocos da ROM PRG são traduzidos, o código da RAM pode ser alterado
+        const Bloco* bloco = this->bloco_atual;
+        if (bloco->inicio < 0x8000)
+        {
+            return false;
+        }
+
+        // os laços de espera ficam com o núcleo de blocos, já que 'Nes::avancar_laco_espera'
+        // precisa executar uma repetição instrução por instrução antes de pular as próximas
+        if (bloco->espera != BlocoEspera::NENHUMA)
+        {
+            return false;
+        }
+
+        if (!bloco->is_traduzido && this->nucleo == CpuNucleo::ESTATICO)
+        {
+            this->carregar_bloco_estatico(*bloco);
+        }
+        else if (!bloco->is_traduzido)
+        {
+            bloco->execucoes += 1;
+            if (bloco->execucoes < Recompilador::LIMIAR_EXECUCOES)
+            {
+                return false;
+            }
+
+            this->recompilador.traduzir(*bloco);
+        }
+
+        if (bloco->nativo == nullptr)
+        {
+            return false;
+        }
+
+        // a ppu só avança depois do bloco inteiro, então ele só pode ser 
+        // executado se nenhuma interrupção puder ocorrer antes do seu fim
+        if (this->memoria->nes->ppu.pontos_ate_nmi() <= bloco->nativo_ciclos_maximo * 3)
+        {
+            return false;
+        }
+
+        // o bloco inteiro é executado de uma vez, então ele fica com o núcleo de blocos
+        // quando puder passar do limite, que para depois de qualquer instrução
+        if (bloco->nativo_ciclos_maximo > ciclos_limite)
+        {
+            return false;
+        }
+
+        if (this->nucleo == CpuNucleo::DIFERENCIAL)
+        {
+            this->executar_nativo_diferencial(bloco);
+        }
+        else
+        {
+            this->ciclos += bloco->nativo(this);
+        }
+
+        // escritas na RAM podem ter limpado o bloco atual, mas os blocos da ROM continuam válidos
+        this->bloco_atual = bloco;
+        this->bloco_indice = bloco->nativo_instrucoes;
+
+        return true;
+    }
+
+    void Cpu::carregar_bloco_estatico(const Bloco& bloco)
+    {
+        bloco.is_traduzido = true;
+        bloco.nativo = nullptr;
+        bloco.nativo_instrucoes = 0;
+        bloco.nativo_ciclos_maximo = 0;
+
+        if (this->programa_estatico == nullptr)
+        {
+            return;
+        }
+
+        const BlocoEstatico* bloco_estatico = this->programa_estatico->buscar(bloco.inicio);
+        if (bloco_estatico == nullptr || bloco_estatico->instrucoes > bloco.instrucoes.size())
+        {
+            return;
+        }
+
+        bloco.nativo = bloco_estatico->funcao;
+        bloco.nativo_instrucoes = bloco_estatico->instrucoes;
+        bloco.nativo_ciclos_maximo = bloco_estatico->ciclos_maximo;
+    }
+
+    void Cpu::executar_nativo_diferencial(const Bloco* bloco)
+    {
+        auto registradores = [this]() -> array<uint32, 7>
+        {
+            return { this->pc, this->a, this->x, this->y, this->sp, this->get_estado(), this->ciclos };
+        };
+
+        const auto registradores_iniciais = registradores();
+        const auto ram_inicial = this->memoria->get_ram();
+
+        this->ciclos += bloco->nativo(this);
+
+        const auto registradores_nativos = registradores();
+        const auto ram_nativa = this->memoria->get_ram();
+
+        // voltar ao estado inicial e executar as mesmas instruções com o núcleo de blocos
+        this->pc = registradores_iniciais.at(0);
+        this->a = registradores_iniciais.at(1);
+        this->x = registradores_iniciais.at(2);
+        this->y = registradores_iniciais.at(3);
+        this->sp = registradores_iniciais.at(4);
+        this->set_estado(registradores_iniciais.at(5));
+        this->ciclos = registradores_iniciais.at(6);
+        this->memoria->set_ram(ram_inicial);
+
+        for (size_t i = 0; i < bloco->nativo_instrucoes; i++)
+        {
+            const BlocoInstrucao& bloco_instrucao = bloco->instrucoes.at(i);
+            this->ciclos += bloco_instrucao.implementacao(this, bloco_instrucao.operando);
+        }
+
+        const auto registradores_interpretados = registradores();
+        if (registradores_interpretados != registradores_nativos || this->memoria->get_ram() != ram_nativa)
+        {
+            const array<string, 7> nomes = { "pc", "a", "x", "y", "sp", "p", "ciclos" };
+
+            stringstream erro_ss;
+            erro_ss << "Divergência no código nativo do bloco $" << std::hex << bloco->inicio << ":";
+            for (size_t i = 0; i < nomes.size(); i++)
+            {
+                erro_ss << " " << nomes.at(i) << "=" << registradores_nativos.at(i);
+                erro_ss << "/" << registradores_interpretados.at(i);
+            }
+            if (this->memoria->get_ram() != ram_nativa)
+            {
+                erro_ss << " (RAM diferente)";
+            }
+
+            throw runtime_error(erro_ss.str());
+        }
+    }
+
+    void Cpu::pular_laco_espera(const Bloco* laco, size_t indice, uint32 ciclos)
+    {
+        this->pc = laco->instrucoes.at(indice).pc;
+        this->ciclos += ciclos;
+        this->bloco_atual = laco;
+        this->bloco_indice = indice;
+    }
+
     void Cpu::resetar()
     {
+        this->invalidar_blocos();
+
         this->pc = this->memoria->ler_16_bits(0xFFFC);
         this->sp = 0xFD;
         this->set_estado(0x24);
@@ -139,12 +471,12 @@ namespace nesbrasa::nucleo
         byte flags = 0;
 
         const byte c = this->c;
-        const byte z = this->z << 1;
+        const byte z = this->get_z() << 1;
         const byte i = this->i << 2;
         const byte d = this->d << 3;
         const byte b = this->b << 4;
         const byte v = this->v << 6;
-        const byte n = this->n << 7;
+        const byte n = this->get_n() << 7;
         // o bit na posiçao 5 sempre está ativo
         const byte bit_5 = 1 << 5;
 
@@ -154,12 +486,12 @@ namespace nesbrasa::nucleo
     void Cpu::set_estado(byte valor)
     {
         this->c = buscar_bit(valor, 0);
-        this->z = buscar_bit(valor, 1);
+        this->z_valor = buscar_bit(valor, 1) ? 0 : 1;
         this->i = buscar_bit(valor, 2);
         this->d = buscar_bit(valor, 3);
         this->b = buscar_bit(valor, 4);
         this->v = buscar_bit(valor, 6);
-        this->n = buscar_bit(valor, 7);
+        this->n_valor = valor & 0x80;
     }
 
     void Cpu::stack_empurrar(byte valor)
@@ -199,43 +531,54 @@ namespace nesbrasa::nucleo
         this->esperar += esperar;
     }
 
-    void Cpu::set_z(byte valor)
+    uint32 Cpu::get_ciclos()
     {
-        // checa se um valor é '0'
-        if (valor == 0)
-            this->z = true;
-        else
-            this->z = false;
+        return this->ciclos;
     }
 
-    void Cpu::set_n(byte valor)
+    uint16 Cpu::get_esperar()
     {
-        // o valor é negativo se o bit mais significativo não for '0'
-        if ((valor & 0b10000000) != 0)
-            this->n = true;
-        else
-            this->n = false;
+        return this->esperar;
     }
-    
-    uint32 Cpu::get_ciclos()
+
+    CpuNucleo Cpu::get_nucleo()
     {
-        return this->ciclos;
+        return this->nucleo;
     }
 
-    uint16 Cpu::get_esperar()
+    void Cpu::set_nucleo(CpuNucleo nucleo)
     {
-        return this->esperar;
+        // os núcleos dinâmico e estático guardam código diferente nos mesmos blocos
+        if (this->nucleo != nucleo)
+        {
+            this->invalidar_blocos();
+        }
+
+        this->nucleo = nucleo;
+    }
+
+    void Cpu::set_programa_estatico(const ProgramaEstatico* programa)
+    {
+        if (programa != nullptr && programa->prg_hash != calcular_hash_prg(this->memoria))
+        {
+            throw runtime_error("Erro: o programa estático foi gerado a partir de outra ROM");
+        }
+
+        this->programa_estatico = programa;
+        this->invalidar_blocos();
     }
 
-    optional<Instrucao> Cpu::get_instrucao(byte opcode)
+    const Instrucao& Cpu::get_instrucao(byte opcode)
     {
-        return this->instrucoes.at(opcode);
+        return tabela_instrucoes.at(opcode);
     }
 
     string Cpu::instrucao_para_asm(byte opcode)
     {
+        const Instrucao& instrucao = tabela_instrucoes.at(opcode);
+
         // lançar erro se a instrução não existir na tabela
-        if (!this->instrucoes.at(opcode).has_value())
+        if (!instrucao.is_valida())
         {
             stringstream erro_ss;
             erro_ss << "Instrução não reconhecida: ";
@@ -244,8 +587,6 @@ namespace nesbrasa::nucleo
             throw runtime_error(erro_ss.str());
         }
 
-        auto instrucao = this->instrucoes.at(opcode).value();
-
         switch (instrucao.modo)
         {
             case InstrucaoModo::ACM:
@@ -377,4 +718,19 @@ namespace nesbrasa::nucleo
                 return "???";
         }
     }
+
+    void Cpu::invalidar_blocos()
+    {
+        this->blocos.limpar();
+        this->recompilador.limpar();
+        this->bloco_atual = nullptr;
+    }
+
+    void Cpu::invalidar_blocos_ram(uint16 endereco)
+    {
+        if (this->blocos.invalidar_ram(endereco))
+        {
+            this->bloco_atual = nullptr;
+        }
+    }
 }
\ No newline at end of file
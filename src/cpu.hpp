@@ -20,11 +20,16 @@
 
 #include <cstdint>
 #include <array>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 
 #include "instrucao.hpp"
 #include "memoria.hpp"
+#include "blocos.hpp"
+#include "recompilador.hpp"
+#include "estatico.hpp"
 
 // referencias utilizadas:
 // http://www.obelisk.me.uk/6502/registers.html
@@ -32,6 +37,7 @@
 namespace nesbrasa::nucleo
 {
     using std::array;
+    using std::string;
     using std::shared_ptr;
     using std::optional;
 
@@ -42,14 +48,48 @@ namespace nesbrasa::nucleo
         NENHUMA,
     };
 
+    //! Núcleos disponíveis para executar as instruções
+    enum class CpuNucleo
+    {
+        // busca o endereço e chama a implementação através da tabela de instruções
+        TABELA,
+        // usa as instruções especializadas em tempo de compilação para cada opcode
+        ESPECIALIZADO,
+        // executa blocos de instruções já decodificadas guardados em um cache
+        BLOCOS,
+        // igual ao núcleo de blocos, mas traduz os blocos mais executados da ROM PRG para código nativo
+        DINAMICO,
+        // executa o código nativo e o núcleo de blocos lado a lado, lançando
+        // um erro caso os registradores, os ciclos ou a RAM sejam diferentes
+        DIFERENCIAL,
+        // igual ao núcleo de blocos, mas executa os blocos compilados antecipadamente
+        // pela ferramenta 'nesbrasa-recompilar', definidos com 'set_programa_estatico'
+        ESTATICO,
+    };
+
     class Cpu
     {
+        friend class Recompilador;
+
     private:
         uint16 esperar;
         uint32 ciclos;
 
-        // tabela de instruções
-        array< optional<Instrucao>, 256 > instrucoes;
+        CpuNucleo nucleo;
+
+        // as flags 'n' e 'z' só são calculadas quando forem lidas, 
+        // a partir do último resultado que as alterou
+        byte n_valor; // a flag de negativo está ativa quando o bit 7 estiver ativo
+        byte z_valor; // a flag zero está ativa quando o valor for 0
+
+        BlocoCache blocos;
+        // bloco em execução e a posição da próxima instrução a ser executada nele
+        const Bloco* bloco_atual;
+        size_t bloco_indice;
+
+        Recompilador recompilador;
+
+        const ProgramaEstatico* programa_estatico;
     
     public:
 
@@ -65,21 +105,29 @@ namespace nesbrasa::nucleo
         byte y; // registrador de indice y
 
         bool c; // flag de carregamento (carry flag)
-        bool z; // flag zero
         bool i; // flag de desabilitar interrupções
         bool d; // flag decimal
         bool b; // flag da instrução break (break command flag)
         bool v; // flag de transbordamento (overflow flag)
-        bool n; // flag de negativo
 
         bool is_pag_alterada;
 
         Cpu(Memoria* memoria);
 
         /*! Executa a próxima instrução
+            \param ciclos_limite Os blocos de código nativo só são executados quando não podem passar do limite
             \return Quantidade de ciclos que foram executados
          */  
-        uint avancar();
+        uint avancar(uint32 ciclos_limite = std::numeric_limits<uint32>::max());
+
+        /*! Executa instruções até completar a quantidade de ciclos pedida, adiando os pontos
+            correspondentes da ppu depois de cada uma. As instruções de um bloco do cache são
+            executadas em sequência, sem buscar o bloco novamente a cada instrução
+            \param ciclos_limite A execução para depois da primeira instrução que alcançar o limite
+            \param parar_em_lacos Para no início dos laços de espera, para que eles possam ser pulados
+            \return Quantidade de ciclos que foram executados
+        */
+        uint32 executar_ciclos(uint32 ciclos_limite, bool parar_em_lacos);
 
         void resetar();
 
@@ -109,18 +157,91 @@ namespace nesbrasa::nucleo
         string instrucao_para_asm(byte opcode);
 
         //! Ativa a flag de zero caso seja necessario
-        void set_z(byte valor);
+        inline void set_z(byte valor)
+        {
+            this->z_valor = valor;
+        }
 
         //! Ativa a flag de valor negativo caso seja necessario
-        void set_n(byte valor);
+        inline void set_n(byte valor)
+        {
+            this->n_valor = valor;
+        }
+
+        //! Altera as flags de zero e de valor negativo a partir do resultado de uma operação
+        inline void set_nz(byte valor)
+        {
+            this->n_valor = valor;
+            this->z_valor = valor;
+        }
+
+        //! Flag zero
+        inline bool get_z() const
+        {
+            return this->z_valor == 0;
+        }
+
+        //! Flag de negativo
+        inline bool get_n() const
+        {
+            return (this->n_valor & 0x80) != 0;
+        }
         
         uint32 get_ciclos();
 
         uint16 get_esperar();
 
-        optional<Instrucao> get_instrucao(byte opcode);
+        CpuNucleo get_nucleo();
+
+        void set_nucleo(CpuNucleo nucleo);
+
+        /*! Define o programa compilado usado pelo núcleo estático. Deve ser chamado
+            depois de carregar a ROM, já que 'Nes::carregar_rom' descarta o programa atual.
+            Lança um erro caso o programa tenha sido gerado a partir de outra ROM PRG
+            \param programa O programa, ou nullptr para descartar o programa atual
+        */
+        void set_programa_estatico(const ProgramaEstatico* programa);
+
+        const Instrucao& get_instrucao(byte opcode);
+
+        //! Descarta todos os blocos do cache, deve ser usado quando a ROM PRG for alterada
+        void invalidar_blocos();
+
+        //! Descarta os blocos da RAM que contêm um endereço que acabou de ser escrito
+        void invalidar_blocos_ram(uint16 endereco);
+
+        /*! Busca o laço de espera que começa no pc, caso a próxima instrução seja o início de um.
+            \return O bloco do laço, ou nullptr caso a cpu não esteja no início de um laço de espera
+        */
+        const Bloco* buscar_laco_espera();
+
+        /*! Avança o tempo da cpu até uma das instruções de um laço de espera, sem executar as 
+            instruções anteriores. Só deve ser usado quando as repetições puladas não alteram o estado da cpu
+            \param laco Bloco retornado por 'buscar_laco_espera'
+            \param indice Posição da instrução em que a cpu vai parar
+            \param ciclos Quantidade de ciclos das instruções puladas
+        */
+        void pular_laco_espera(const Bloco* laco, size_t indice, uint32 ciclos);
 
     private:
-        void executar(Instrucao* instrucao);
+        void executar(const Instrucao* instrucao);
+
+        //! Busca no cache de blocos a instrução localizada no endereço do pc
+        const BlocoInstrucao* buscar_bloco_instrucao();
+
+        //! Aponta o bloco atual para a instrução do pc, retorna false caso ela não possa ser guardada no cache
+        bool posicionar_bloco();
+
+        //! Preenche os campos 'nativo*' do bloco com o bloco correspondente do programa estático
+        void carregar_bloco_estatico(const Bloco& bloco);
+
+        /*! Executa o código nativo do bloco que começa no pc, traduzindo o bloco caso necessário
+            \param ciclos_limite Quantidade máxima de ciclos que o bloco pode executar
+            \return false caso o bloco não possa ser executado pelo código nativo
+        */
+        bool executar_nativo(uint32 ciclos_limite);
+
+        //! Executa o código nativo e refaz as mesmas instruções com o núcleo de blocos, comparando os resultados
+        void executar_nativo_diferencial(const Bloco* bloco);
     };
 }
\ No newline at end of file
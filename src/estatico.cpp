@@ -0,0 +1,54 @@
+/* estatico.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "estatico.hpp"
+#include "memoria.hpp"
+
+namespace nesbrasa::nucleo
+{
+    const BlocoEstatico* ProgramaEstatico::buscar(uint16 inicio) const
+    {
+        const BlocoEstatico* fim = this->blocos + this->blocos_quantidade;
+        const BlocoEstatico* bloco = std::lower_bound(this->blocos, fim, inicio,
+            [](const BlocoEstatico& bloco, uint16 inicio)
+            {
+                return bloco.inicio < inicio;
+            });
+
+        if (bloco == fim || bloco->inicio != inicio)
+        {
+            return nullptr;
+        }
+
+        return bloco;
+    }
+
+    uint32 calcular_hash_prg(Memoria* memoria)
+    {
+        uint32 hash = 0x811C9DC5;
+        for (uint32 endereco = 0x8000; endereco <= 0xFFFF; endereco++)
+        {
+            hash ^= memoria->ler(static_cast<uint16>(endereco));
+            hash *= 0x01000193;
+        }
+
+        return hash;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+/* estatico.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "blocos.hpp"
+#include "tipos_numeros.hpp"
+
+namespace nesbrasa::nucleo
+{
+    using namespace nesbrasa::tipos;
+
+    class Memoria;
+
+    //! Bloco da ROM PRG compilado antecipadamente pela ferramenta 'nesbrasa-recompilar'
+    struct BlocoEstatico
+    {
+        uint16 inicio;        // endereço da primeira instrução
+        uint16 instrucoes;    // quantidade de instruções executadas pela função
+        uint32 ciclos_maximo; // quantidade máxima de ciclos que a função pode levar
+        BlocoNativo funcao;
+    };
+
+    /*! Programa gerado pela ferramenta 'nesbrasa-recompilar' a partir da ROM PRG
+        de um cartucho NROM. Os blocos que não estão no programa, como os destinos
+        de saltos indiretos que não puderam ser resolvidos, são interpretados */
+    struct ProgramaEstatico
+    {
+        uint32 prg_hash; // hash dos bytes de $8000-$FFFF usados na geração
+
+        // blocos ordenados pelo endereço de início
+        const BlocoEstatico* blocos;
+        size_t blocos_quantidade;
+
+        /*! Busca o bloco compilado que começa no endereço
+            \return O bloco, ou nullptr caso ele não tenha sido compilado
+        */
+        const BlocoEstatico* buscar(uint16 inicio) const;
+    };
+
+    //! Calcula o hash FNV-1a dos bytes visíveis pela cpu em $8000-$FFFF
+    uint32 calcular_hash_prg(Memoria* memoria);
+}
\ No newline at end of file
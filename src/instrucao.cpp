@@ -19,6 +19,7 @@
 #include <memory>
 #include <iostream>
 #include <bitset>
+#include <utility>
 
 #include "nesbrasa.hpp"
 #include "cpu.hpp"
@@ -28,96 +29,150 @@
 
 namespace nesbrasa::nucleo
 {
-    Instrucao::Instrucao(
-        string nome,
-        byte bytes,
-        int32 ciclos,
-        int32 ciclos_pag_alt,
-        InstrucaoModo modo,
-        InstrucaoImplementacao implementacao
-    )
+    /*!
+    Lê da memória o operando de uma instrução, que fica logo após o opcode.
+    Os modos que não usam um operando para calcular o endereço não leem nada.
+    */
+    template<InstrucaoModo modo>
+    static inline uint16 ler_operando(Cpu* cpu)
     {
-        this->nome = nome;
-        this->bytes = bytes;
-        this->ciclos = ciclos;
-        this->ciclos_pag_alt = ciclos_pag_alt;
-        this->modo = modo;
-        this->implementacao = implementacao;
+        if constexpr (modo == InstrucaoModo::ABS   || modo == InstrucaoModo::ABS_X ||
+                      modo == InstrucaoModo::ABS_Y || modo == InstrucaoModo::IND)
+        {
+            return cpu->memoria->ler_16_bits(cpu->pc + 1);
+        }
+        else if constexpr (modo == InstrucaoModo::P_ZERO   || modo == InstrucaoModo::P_ZERO_X ||
+                           modo == InstrucaoModo::P_ZERO_Y || modo == InstrucaoModo::IND_X    ||
+                           modo == InstrucaoModo::IND_Y    || modo == InstrucaoModo::REL)
+        {
+            return cpu->memoria->ler(cpu->pc + 1);
+        }
+        else
+        {
+            return 0;
+        }
     }
 
-    optional<uint16> Instrucao::buscar_endereco(Cpu* cpu)
+    /*!
+    Calcula o endereço usado por uma instrução a partir do operando já lido,
+    com o modo de endereçamento resolvido em tempo de compilação
+    */
+    template<InstrucaoModo modo>
+    static inline optional<uint16> resolver_endereco(Cpu* cpu, uint16 operando)
     {
         cpu->is_pag_alterada = false;
 
+        if constexpr (modo == InstrucaoModo::ACM || modo == InstrucaoModo::IMPL)
+        {
+            return nullopt;
+        }
+        else if constexpr (modo == InstrucaoModo::IMED)
+        {
+            return cpu->pc + 1;
+        }
+        else if constexpr (modo == InstrucaoModo::P_ZERO)
+        {
+            return operando;
+        }
+        else if constexpr (modo == InstrucaoModo::P_ZERO_X)
+        {
+            return (operando + cpu->x) & 0xFF;
+        }
+        else if constexpr (modo == InstrucaoModo::P_ZERO_Y)
+        {
+            return (operando + cpu->y) & 0xFF;
+        }
+        else if constexpr (modo == InstrucaoModo::ABS)
+        {
+            return operando;
+        }
+        else if constexpr (modo == InstrucaoModo::ABS_X)
+        {
+            uint16 endereco = operando + cpu->x;
+            cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->x, endereco);
+
+            return endereco;
+        }
+        else if constexpr (modo == InstrucaoModo::ABS_Y)
+        {
+            uint16 endereco = operando + cpu->y;
+            cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->y, endereco);
+
+            return endereco;
+        }
+        else if constexpr (modo == InstrucaoModo::IND)
+        {
+            return cpu->memoria->ler_16_bits_bug(operando);
+        }
+        else if constexpr (modo == InstrucaoModo::IND_X)
+        {
+            return cpu->memoria->ler_16_bits_bug((operando + cpu->x)%0x100);
+        }
+        else if constexpr (modo == InstrucaoModo::IND_Y)
+        {
+            uint16 endereco = cpu->memoria->ler_16_bits_bug(operando) + cpu->y;
+            cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->y, endereco);
+
+            return endereco;
+        }
+        else
+        {
+            // modo relativo
+            if (operando < 0x80)
+                return cpu->pc + 2 + operando;
+            else
+                return cpu->pc + 2 + operando - 0x100;
+        }
+    }
+
+    template<InstrucaoModo modo>
+    static inline optional<uint16> buscar_endereco_modo(Cpu* cpu)
+    {
+        return resolver_endereco<modo>(cpu, ler_operando<modo>(cpu));
+    }
+
+    optional<uint16> Instrucao::buscar_endereco(Cpu* cpu) const
+    {
         switch (this->modo)
         {
             case InstrucaoModo::ACM:
-                return nullopt;
+                return buscar_endereco_modo<InstrucaoModo::ACM>(cpu);
 
             case InstrucaoModo::IMPL:
-                return nullopt;
+                return buscar_endereco_modo<InstrucaoModo::IMPL>(cpu);
 
             case InstrucaoModo::IMED:
-                return cpu->pc + 1;
+                return buscar_endereco_modo<InstrucaoModo::IMED>(cpu);
 
             case InstrucaoModo::P_ZERO:
-                return cpu->memoria->ler(cpu->pc + 1);
+                return buscar_endereco_modo<InstrucaoModo::P_ZERO>(cpu);
 
             case InstrucaoModo::P_ZERO_X:
-                return (cpu->memoria->ler(cpu->pc + 1) + cpu->x) & 0xFF;
+                return buscar_endereco_modo<InstrucaoModo::P_ZERO_X>(cpu);
 
             case InstrucaoModo::P_ZERO_Y:
-                return (cpu->memoria->ler(cpu->pc + 1) + cpu->y) & 0xFF;
+                return buscar_endereco_modo<InstrucaoModo::P_ZERO_Y>(cpu);
 
             case InstrucaoModo::ABS:
-                return cpu->memoria->ler_16_bits(cpu->pc + 1);
+                return buscar_endereco_modo<InstrucaoModo::ABS>(cpu);
 
             case InstrucaoModo::ABS_X:
-            {
-                uint16 endereco = cpu->memoria->ler_16_bits(cpu->pc + 1) + cpu->x;
-                cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->x, endereco);
-
-                return endereco;
-            }
+                return buscar_endereco_modo<InstrucaoModo::ABS_X>(cpu);
 
             case InstrucaoModo::ABS_Y:
-            {
-                uint16 endereco =  cpu->memoria->ler_16_bits(cpu->pc + 1) + cpu->y;
-                cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->y, endereco);
-
-                return endereco;
-            }
+                return buscar_endereco_modo<InstrucaoModo::ABS_Y>(cpu);
 
             case InstrucaoModo::IND:
-            {
-                const uint16 valor = cpu->memoria->ler_16_bits(cpu->pc+1);
-                return cpu->memoria->ler_16_bits_bug(valor);
-            }
+                return buscar_endereco_modo<InstrucaoModo::IND>(cpu);
 
             case InstrucaoModo::IND_X:
-            {
-                const uint16 valor = cpu->memoria->ler(cpu->pc + 1);
-                return cpu->memoria->ler_16_bits_bug((valor + cpu->x)%0x100);
-            }
+                return buscar_endereco_modo<InstrucaoModo::IND_X>(cpu);
 
             case InstrucaoModo::IND_Y:
-            {
-                const uint16 valor = cpu->memoria->ler(cpu->pc + 1);
-                uint16 endereco = cpu->memoria->ler_16_bits_bug(valor) + cpu->y;
-                cpu->is_pag_alterada = !comparar_paginas(endereco - cpu->y, endereco);
-
-                return endereco;
-            }
+                return buscar_endereco_modo<InstrucaoModo::IND_Y>(cpu);
 
             case InstrucaoModo::REL:
-            {
-                const uint16 valor = cpu->memoria->ler(cpu->pc + 1);
-
-                if (valor < 0x80)
-                    return cpu->pc + 2 + valor;
-                else
-                    return cpu->pc + 2 + valor - 0x100;
-            }
+                return buscar_endereco_modo<InstrucaoModo::REL>(cpu);
         }
 
         return 0;
@@ -127,7 +182,7 @@ namespace nesbrasa::nucleo
     Instrução ADC
     A + M + C -> A, C
     */
-    static void instrucao_adc(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_adc(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -151,15 +206,14 @@ namespace nesbrasa::nucleo
             cpu->v = 0;
 
         // atualiza as flags z e n
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*!
     Instrução AND
     A AND M -> A
     */
-    static void instrucao_and(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_and(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -169,15 +223,14 @@ namespace nesbrasa::nucleo
         cpu->a = a & m;
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*!
     Instrução shift para a esquerda.
     Utiliza a memoria ou o acumulador
     */
-    static void instrucao_asl(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_asl(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (instrucao->modo == InstrucaoModo::ACM)
         {
@@ -187,8 +240,7 @@ namespace nesbrasa::nucleo
             cpu->a <<= 1;
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
         else
         {
@@ -202,13 +254,12 @@ namespace nesbrasa::nucleo
             cpu->memoria->escrever(endereco.value(), valor);
 
             // atualizar flags
-            cpu->set_n(valor);
-            cpu->set_z(valor);
+            cpu->set_nz(valor);
         }
     }
 
     //! Pula para o endereço indicado se a flag 'c' não estiver ativa
-    static void instrucao_bcc(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bcc(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (cpu->c == false)
         {
@@ -218,7 +269,7 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'c' estiver ativa
-    static void instrucao_bcs(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bcs(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (cpu->c == true)
         {
@@ -228,9 +279,9 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'z' estiver ativa
-    static void instrucao_beq(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_beq(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
-        if (cpu->z == true)
+        if (cpu->get_z() == true)
         {
             cpu->branch_somar_ciclos(endereco.value());
             cpu->pc = endereco.value();
@@ -242,19 +293,19 @@ namespace nesbrasa::nucleo
     e a posição 6 do byte em 'v'.
     A flag 'z' tambem é alterada sendo calculada com 'a' AND valor
     */
-    static void instrucao_bit(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bit(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
-        cpu->n = buscar_bit(valor, 7);
+        cpu->set_n(valor);
         cpu->v = buscar_bit(valor, 6);
-        cpu->z = (valor & cpu->a) == 0;
+        cpu->set_z(valor & cpu->a);
     }
 
     //! Pula para o endereço indicado se a flag 'n' estiver ativa
-    static void instrucao_bmi(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bmi(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
-        if (cpu->n == true)
+        if (cpu->get_n() == true)
         {
             cpu->branch_somar_ciclos(endereco.value());
             cpu->pc = endereco.value();
@@ -262,9 +313,9 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'z' não estiver ativa
-    static void instrucao_bne(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bne(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
-        if (cpu->z == false)
+        if (cpu->get_z() == false)
         {
             cpu->branch_somar_ciclos(endereco.value());
             cpu->pc = endereco.value();
@@ -272,9 +323,9 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'n' não estiver ativa
-    static void instrucao_bpl(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bpl(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
-        if (cpu->n == false)
+        if (cpu->get_n() == false)
         {
             cpu->branch_somar_ciclos(endereco.value());
             cpu->pc = endereco.value();
@@ -282,7 +333,7 @@ namespace nesbrasa::nucleo
     }
 
     //! Instrução BRK
-    static void instrucao_brk(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_brk(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->stack_empurrar_16_bits(cpu->pc);
         cpu->stack_empurrar(cpu->get_estado());
@@ -292,7 +343,7 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'v' não estiver ativa
-    static void instrucao_bvc (Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bvc (const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (cpu->v == false)
         {
@@ -302,7 +353,7 @@ namespace nesbrasa::nucleo
     }
 
     //! Pula para o endereço indicado se a flag 'v' estiver ativa
-    static void instrucao_bvs(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_bvs(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (cpu->v == true)
         {
@@ -312,31 +363,31 @@ namespace nesbrasa::nucleo
     }
 
     //! Limpa a flag 'c'
-    static void instrucao_clc(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_clc(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->c = false;
     }
 
     //! Limpa a flag 'd'
-    static void instrucao_cld(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_cld(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->d = false;
     }
 
     //! Limpa a flag 'i'
-    static void instrucao_cli(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_cli(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->i = false;
     }
 
     //! Limpa a flag 'v'
-    static void instrucao_clv(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_clv(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->v = false;
     }
 
     //! Compara o acumulador com um valor
-    static void instrucao_cmp(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_cmp(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -348,12 +399,11 @@ namespace nesbrasa::nucleo
         byte resultado = cpu->a - valor;
 
         // atualizar flags
-        cpu->set_n(resultado);
-        cpu->set_z(resultado);
+        cpu->set_nz(resultado);
     }
 
     //! Compara o indice X com um valor
-    static void instrucao_cpx(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_cpx(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -365,12 +415,11 @@ namespace nesbrasa::nucleo
         byte resultado = cpu->x - valor;
 
         // atualizar flags
-        cpu->set_n(resultado);
-        cpu->set_z(resultado);
+        cpu->set_nz(resultado);
     }
 
     //! Compara o indice Y com um valor
-    static void instrucao_cpy(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_cpy(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -380,12 +429,11 @@ namespace nesbrasa::nucleo
             cpu->c = false;
 
         byte resultado = cpu->y - valor;
-        cpu->set_n(resultado);
-        cpu->set_z (resultado);
+        cpu->set_nz(resultado);
     }
 
     //! Diminui um valor na memoria por 1
-    static void instrucao_dec(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_dec(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -395,44 +443,40 @@ namespace nesbrasa::nucleo
         cpu->memoria->escrever(endereco.value(), valor);
 
         // atualizar flags
-        cpu->set_n(valor);
-        cpu->set_z(valor);
+        cpu->set_nz(valor);
     }
 
     //! Diminui o valor do indice X por 1
-    static void instrucao_dex(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_dex(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->x -= 1;
 
         // atualizar flags
-        cpu->set_n(cpu->x);
-        cpu->set_z(cpu->x);
+        cpu->set_nz(cpu->x);
     }
 
     //! Diminui o valor do indice Y por 1
-    static void instrucao_dey(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_dey(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->y -= 1;
 
         // atualizar flags
-        cpu->set_n(cpu->y);
-        cpu->set_z(cpu->y);
+        cpu->set_nz(cpu->y);
     }
 
     //! OR exclusivo de um valor na memoria com o acumulador
-    static void instrucao_eor(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_eor(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
         cpu->a = cpu->a ^ valor;
 
         //atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Incrementa um valor na memoria por 1
-    static void instrucao_inc(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_inc(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -442,39 +486,36 @@ namespace nesbrasa::nucleo
         cpu->memoria->escrever(endereco.value(), valor);
 
         // atualizar flags
-        cpu->set_n(valor);
-        cpu->set_z(valor);
+        cpu->set_nz(valor);
     }
 
     //! Incrementa o valor do indice X por 1
-    static void instrucao_inx(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_inx(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->x += 1;
 
         // atualizar flags
-        cpu->set_n(cpu->x);
-        cpu->set_z(cpu->x);
+        cpu->set_nz(cpu->x);
     }
 
     //! Incrementa o valor do indice Y por 1
-    static void instrucao_iny(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_iny(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->y += 1;
 
         // atualizar flags
-        cpu->set_n(cpu->y);
-        cpu->set_z(cpu->y);
+        cpu->set_nz(cpu->y);
     }
 
     //! Pula o programa para o endereço indicado
-    static void instrucao_jmp(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_jmp(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         // muda o endereço
         cpu->pc = endereco.value();
     }
 
     //! Chama uma função/subrotina
-    static void instrucao_jsr(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_jsr(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         // Salva o endereço da próxima instrução subtraído por 1 na stack.
         // O endereço guardado vai ser usado para retornar da função quando
@@ -486,42 +527,39 @@ namespace nesbrasa::nucleo
     }
 
     //! Carrega um valor da memoria no acumulador
-    static void instrucao_lda(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_lda(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->a = cpu->memoria->ler(endereco.value());
         //std::cout << "A: " << std::bitset<8>(cpu->a) << "\n";
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
 
     //! Carrega um valor da memoria no indice X
-    static void instrucao_ldx(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_ldx(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->x = cpu->memoria->ler(endereco.value());
 
         // atualizar flags
-        cpu->set_n(cpu->x);
-        cpu->set_z(cpu->x);
+        cpu->set_nz(cpu->x);
     }
 
     //! Carrega um valor da memoria no acumulador
-    static void instrucao_ldy(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_ldy(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->y = cpu->memoria->ler(endereco.value());
 
         // atualizar flags
-        cpu->set_n(cpu->y);
-        cpu->set_z(cpu->y);
+        cpu->set_nz(cpu->y);
     }
 
     /*!
     Instrução shift para a direita.
     Utiliza a memoria ou o acumulador
     */
-    static void instrucao_lsr(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_lsr(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (instrucao->modo == InstrucaoModo::ACM)
         {
@@ -531,8 +569,7 @@ namespace nesbrasa::nucleo
             cpu->a >>= 1;
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
         else
         {
@@ -546,60 +583,57 @@ namespace nesbrasa::nucleo
             cpu->memoria->escrever(endereco.value(), valor);
 
             // atualizar flags
-            cpu->set_n(valor);
-            cpu->set_z(valor);
+            cpu->set_nz(valor);
         }
     }
 
     //! Não fazer nada
-    static void instrucao_nop(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_nop(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
     }
 
     //! Operanção OR entre um valor na memoria e o A
-    static void instrucao_ora(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_ora(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
         cpu->a = cpu->a | valor;
 
         //atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Empurra o valor do acumulador na stack
-    static void instrucao_pha(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_pha(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->stack_empurrar(cpu->a);
     }
 
     //! Empurra o valor do estado do processador na stack
-    static void instrucao_php(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_php(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         const byte estado = cpu->get_estado();
         cpu->stack_empurrar(estado);
     }
 
     //! Puxa um valor da stack e salva esse valor no acumulador
-    static void instrucao_pla(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_pla(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->a = cpu->stack_puxar();
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Puxa um valor da stack e salva esse valor no estado do processador
-    static void instrucao_plp(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_plp(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         const byte estado = cpu->stack_puxar();
         cpu->set_estado(estado);
     }
 
     //! Gira um valor pra a esquerda
-    static void instrucao_rol(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_rol(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (instrucao->modo == InstrucaoModo::ACM)
         {
@@ -609,8 +643,7 @@ namespace nesbrasa::nucleo
             cpu->a = cpu->a | ((carregar) ? 1 : 0);
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
         else
         {
@@ -625,13 +658,12 @@ namespace nesbrasa::nucleo
             cpu->memoria->escrever(endereco.value(), valor);
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
     }
 
     //! Gira um valor pra a direita
-    static void instrucao_ror(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_ror(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         if (instrucao->modo == InstrucaoModo::ACM)
         {
@@ -641,8 +673,7 @@ namespace nesbrasa::nucleo
             cpu->a = cpu->a | ((carregar) ? 0b10000000 : 0);
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
         else
         {
@@ -657,13 +688,12 @@ namespace nesbrasa::nucleo
             cpu->memoria->escrever(endereco.value(), valor);
 
             // atualizar flags
-            cpu->set_n(cpu->a);
-            cpu->set_z(cpu->a);
+            cpu->set_nz(cpu->a);
         }
     }
 
     //! Retorna de uma interupção
-    static void instrucao_rti(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_rti(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         const byte estado = cpu->stack_puxar();
         cpu->set_estado(estado);
@@ -672,13 +702,13 @@ namespace nesbrasa::nucleo
     }
 
     //! Retorna de uma função/sub-rotina
-    static void instrucao_rts(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_rts(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->pc = cpu->stack_puxar_16_bits() + 1;
     }
 
     //! Subtrai um valor da memoria usando o acumulador
-    static void instrucao_sbc(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sbc(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -701,126 +731,119 @@ namespace nesbrasa::nucleo
             cpu->v = 0;
 
         // atualiza as flags z e n
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Ativa a flag 'c'
-    static void instrucao_sec(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sec(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->c = true;
     }
 
     //! Ativa a flag 'd'
-    static void instrucao_sed(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sed(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->d = true;
     }
 
     //! Ativa a flag 'i'
-    static void instrucao_sei(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sei(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->i = true;
     }
 
     //! Guarda o valor do acumulador na memoria
-    static void instrucao_sta(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sta(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->memoria->escrever(endereco.value(), cpu->a);
     }
 
     //! Guarda o valor do registrador 'x' na memoria
-    static void instrucao_stx(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_stx(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->memoria->escrever(endereco.value(), cpu->x);
     }
 
     //! Guarda o valor do registrador 'y' na memoria
-    static void instrucao_sty(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sty(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->memoria->escrever(endereco.value(), cpu->y);
     }
 
     //! Atribui o valor do acumulador ao registrador 'x'
-    static void instrucao_tax(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_tax(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->x = cpu->a;
 
         // atualizar flags
-        cpu->set_n(cpu->x);
-        cpu->set_z(cpu->x);
+        cpu->set_nz(cpu->x);
     }
 
     //! Atribui o valor do acumulador ao registrador 'y'
-    static void instrucao_tay(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_tay(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->y = cpu->a;
 
         // atualizar flags
-        cpu->set_n(cpu->y);
-        cpu->set_z(cpu->y);
+        cpu->set_nz(cpu->y);
     }
 
     //! Atribui o valor do ponteiro da stack ao registrador 'x'
-    static void instrucao_tsx(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_tsx(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->x = cpu->sp;
 
         // atualizar flags
-        cpu->set_n(cpu->x);
-        cpu->set_z(cpu->x);
+        cpu->set_nz(cpu->x);
     }
 
     //! Atribui o valor do registrador 'x' ao acumulador
-    static void instrucao_txa(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_txa(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->a = cpu->x;
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Atribui o valor do registrador 'x' ao ponteiro da stack
-    static void instrucao_txs(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_txs(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->sp = cpu->x;
     }
 
     //! Atribui o valor do registrador 'y' ao acumulador
-    static void instrucao_tya(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_tya(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         cpu->a = cpu->y;
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     //! Instrução não-oficial *DOP - nenhuma operação
-    static void instrucao_dop(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_dop(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
     }
 
     //! Instrução não-oficial *TOP - nenhuma operação
-    static void instrucao_top(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_top(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
     }
 
     //! Instrução não-oficial *LAX - Transfere um valor da memória para A e X
-    static void instrucao_lax(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_lax(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
         cpu->a = valor;
         cpu->x = valor;
 
-        cpu->set_n(valor);
-        cpu->set_z(valor);
+        cpu->set_nz(valor);
     }
 
     //! Instrução não-oficial *SAX - Faz a operação AND entre o A e o X e guarda o resultado na memória
-    static void instrucao_sax(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sax(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->a & cpu->x;
 
@@ -828,7 +851,7 @@ namespace nesbrasa::nucleo
     }
 
     //! Instrução não-oficial *DCP - Subtrai um valor da memória e compara o resultado com A
-    static void instrucao_dcp(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_dcp(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
         byte resultado = valor - 1;
@@ -844,12 +867,11 @@ namespace nesbrasa::nucleo
             cpu->c = false;
 
         // atualizar flags
-        cpu->set_n(comparacao);
-        cpu->set_z(comparacao);
+        cpu->set_nz(comparacao);
     }
 
     //! Instrução não-oficial *ISB - Incrementa um valor na memória, depois subtrai este valor por A
-    static void instrucao_isb(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_isb(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
         byte resultado = valor + 1;
@@ -875,15 +897,14 @@ namespace nesbrasa::nucleo
             cpu->v = 0;
 
         // atualiza as flags z e n
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*! 
     Instrução não-oficial *SLO: 
     Realiza um shift para a esquerda em um valor,e depois a operação OR entre A e o valor
     */
-    static void instrucao_slo(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_slo(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -897,15 +918,14 @@ namespace nesbrasa::nucleo
         cpu->a = cpu->a | valor;
 
         //atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*! 
     Instrução não-oficial *RLA: 
     Gira um valor na memória para a esquerda, e depois realiza a operação AND entre A e o valor
     */
-    static void instrucao_rla(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_rla(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -921,15 +941,14 @@ namespace nesbrasa::nucleo
         cpu->a = cpu->a & valor;
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*! 
     Instrução não-oficial *SRE: 
     Realiza um shift para a direita em um valor, e depois a operação EOR entre A e o valor
     */
-    static void instrucao_sre(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_sre(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -943,15 +962,14 @@ namespace nesbrasa::nucleo
         cpu->a = cpu->a ^ valor; 
 
         // atualizar flags
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
     /*! 
     Instrução não-oficial *RRA: 
     Gira um valor na memória para a direita, e depois soma o valor com A e C
     */
-    static void instrucao_rra(Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
+    static void instrucao_rra(const Instrucao* instrucao, Cpu* cpu, optional<uint16> endereco)
     {
         byte valor = cpu->memoria->ler(endereco.value());
 
@@ -984,18 +1002,14 @@ namespace nesbrasa::nucleo
             cpu->v = 0;
 
         // atualiza as flags z e n
-        cpu->set_n(cpu->a);
-        cpu->set_z(cpu->a);
+        cpu->set_nz(cpu->a);
     }
 
-    array< optional<Instrucao>, 256 > carregar_instrucoes()
+    static constexpr array<Instrucao, 256> carregar_instrucoes()
     {
-        // cria um array que será usado como uma tabela de instruções
-        array< optional<Instrucao>, 256 > instrucoes;
-        for (auto& instrucao : instrucoes)
-        {
-            instrucao = nullopt;
-        }
+        // cria um array que será usado como uma tabela de instruções,
+        // as entradas que não forem preenchidas continuam inválidas
+        array<Instrucao, 256> instrucoes {};
 
         // modos da instrução ADC
         instrucoes.at(0x69) = Instrucao("ADC", 2, 2, 0, InstrucaoModo::IMED, instrucao_adc);
@@ -1364,4 +1378,67 @@ namespace nesbrasa::nucleo
 
         return instrucoes;
     }
+
+    constexpr array<Instrucao, 256> tabela_instrucoes = carregar_instrucoes();
+
+    /*!
+    Executa a instrução de um opcode com o modo de endereçamento, a
+    implementação e a contagem de ciclos conhecidos em tempo de compilação,
+    o que permite ao compilador fundir tudo em uma única função.
+    \param operando O operando da instrução, já lido da memória
+    \return Quantidade de ciclos da instrução
+    */
+    template<byte opcode>
+    static uint32 instrucao_predecodificada(Cpu* cpu, uint16 operando)
+    {
+        constexpr const Instrucao& instrucao = tabela_instrucoes[opcode];
+
+        if constexpr (!instrucao.is_valida())
+        {
+            // opcodes inválidos são rejeitados antes do despacho
+            return 0;
+        }
+        else
+        {
+            const auto endereco = resolver_endereco<instrucao.modo>(cpu, operando);
+
+            cpu->pc += instrucao.bytes;
+            instrucao.implementacao(&instrucao, cpu, endereco);
+
+            if constexpr (instrucao.ciclos_pag_alt != 0)
+            {
+                if (cpu->is_pag_alterada)
+                    return instrucao.ciclos + instrucao.ciclos_pag_alt;
+            }
+
+            return instrucao.ciclos;
+        }
+    }
+
+    //! Igual a 'instrucao_predecodificada', mas lê o operando da memória
+    template<byte opcode>
+    static uint32 instrucao_especializada(Cpu* cpu)
+    {
+        constexpr InstrucaoModo modo = tabela_instrucoes[opcode].modo;
+
+        return instrucao_predecodificada<opcode>(cpu, ler_operando<modo>(cpu));
+    }
+
+    template<size_t... opcodes>
+    static constexpr array<InstrucaoEspecializada, 256> carregar_instrucoes_especializadas(std::index_sequence<opcodes...>)
+    {
+        return { &instrucao_especializada<opcodes>... };
+    }
+
+    template<size_t... opcodes>
+    static constexpr array<InstrucaoPredecodificada, 256> carregar_instrucoes_predecodificadas(std::index_sequence<opcodes...>)
+    {
+        return { &instrucao_predecodificada<opcodes>... };
+    }
+
+    constexpr array<InstrucaoEspecializada, 256> tabela_instrucoes_especializadas = 
+        carregar_instrucoes_especializadas(std::make_index_sequence<256>());
+
+    constexpr array<InstrucaoPredecodificada, 256> tabela_instrucoes_predecodificadas = 
+        carregar_instrucoes_predecodificadas(std::make_index_sequence<256>());
 }
\ No newline at end of file
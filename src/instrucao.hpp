@@ -18,12 +18,11 @@
 
 #pragma once
 
-#include <functional>
-#include <string>
+#include <string_view>
 #include <array>
 #include <optional>
+#include <memory>
 
-#include "cpu.hpp"
 #include "tipos_numeros.hpp"
 
 // referencias utilizadas:
@@ -32,8 +31,7 @@
 
 namespace nesbrasa::nucleo
 {
-    using std::function;
-    using std::string;
+    using std::string_view;
     using std::array;
     using std::shared_ptr;
     using std::optional;
@@ -45,7 +43,15 @@ namespace nesbrasa::nucleo
 
     // Tipo usado para referenciar funções de alto nível 
     // que reimplementam instruções da arquitetura 6502
-    using InstrucaoImplementacao = std::function< void(Instrucao*, Cpu*, optional<uint16>) >;
+    using InstrucaoImplementacao = void (*)(const Instrucao*, Cpu*, optional<uint16>);
+
+    // Tipo usado para referenciar uma instrução já especializada para o seu
+    // opcode, que busca o próprio operando e retorna a quantidade de ciclos
+    using InstrucaoEspecializada = uint32 (*)(Cpu*);
+
+    // Tipo usado para referenciar uma instrução especializada que recebe o
+    // operando já decodificado, usada pelo cache de blocos da CPU
+    using InstrucaoPredecodificada = uint32 (*)(Cpu*, uint16);
 
     //! Modos de endereçamento das instruções
     enum class InstrucaoModo
@@ -68,7 +74,7 @@ namespace nesbrasa::nucleo
     class Instrucao
     {
     public:
-        string nome;
+        string_view nome;
         byte   bytes;
         int32  ciclos;
 
@@ -81,22 +87,67 @@ namespace nesbrasa::nucleo
         /*! Uma fução de alto nivel que sera usada para reimplementar
             uma instrução da arquitetura 6502 */
         InstrucaoImplementacao implementacao;
-      
-        Instrucao(
-            string nome,
+
+        //! Cria uma entrada vazia, usada para opcodes não reconhecidos
+        constexpr Instrucao():
+            nome(""),
+            bytes(0),
+            ciclos(0),
+            ciclos_pag_alt(0),
+            modo(InstrucaoModo::IMPL),
+            implementacao(nullptr)
+        {
+        }
+
+        constexpr Instrucao(
+            string_view nome,
             byte bytes,
             int32 ciclos,
             int32 ciclos_pag_alt,
             InstrucaoModo modo,
             InstrucaoImplementacao implementacao
-        );
+        ):
+            nome(nome),
+            bytes(bytes),
+            ciclos(ciclos),
+            ciclos_pag_alt(ciclos_pag_alt),
+            modo(modo),
+            implementacao(implementacao)
+        {
+        }
+
+        //! Checa se o opcode desta entrada existe
+        constexpr bool is_valida() const
+        {
+            return this->implementacao != nullptr;
+        }
+
+        //! Checa se a instrução pode desviar o fluxo do programa
+        constexpr bool is_desvio() const
+        {
+            return this->modo == InstrucaoModo::REL ||
+                   this->nome == "JMP" || this->nome == "JSR" ||
+                   this->nome == "RTS" || this->nome == "RTI" ||
+                   this->nome == "BRK";
+        }
 
         /*!
         Busca o endereço que vai ser usado por uma instrução de
         acordo com o modo de endereçamento da CPU
         */
-        optional<uint16> buscar_endereco(Cpu* cpu);
+        optional<uint16> buscar_endereco(Cpu* cpu) const;
     };
 
-    array< optional<Instrucao>, 256 > carregar_instrucoes();
+    /*! Tabela de instruções indexada pelo opcode.
+        É construída em tempo de compilação e compartilhada por todas
+        as instâncias da CPU. */
+    extern const array<Instrucao, 256> tabela_instrucoes;
+
+    /*! Tabela com uma versão de cada opcode gerada em tempo de compilação,
+        usada pelo núcleo especializado da CPU */
+    extern const array<InstrucaoEspecializada, 256> tabela_instrucoes_especializadas;
+
+    /*! Tabela com as versões especializadas que recebem o operando já lido,
+        usada pelo cache de blocos da CPU */
+    extern const array<InstrucaoPredecodificada, 256> tabela_instrucoes_predecodificadas;
 }
\ No newline at end of file
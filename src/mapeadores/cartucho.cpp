@@ -73,6 +73,10 @@ namespace nesbrasa::nucleo::mapeadores
             this->possui_chr_ram = true;
         }
 
+        // janelas sem nenhum banco mapeado
+        this->chr_bancos.fill(nullptr);
+        this->chr_bancos_espelhados.fill(nullptr);
+
         uint rom_prg_tamanho = prg_bancos_qtd * this->PRG_BANCOS_TAMANHO;
         uint rom_chr_tamanho = chr_bancos_qtd * this->CHR_BANCOS_TAMANHO;
 
@@ -123,4 +127,79 @@ namespace nesbrasa::nucleo::mapeadores
     {
         return this->chr_bancos_quantidade;
     }
+
+    const byte* Cartucho::get_pagina(uint16)
+    {
+        return nullptr;
+    }
+
+    const array<const uint32*, 8>& Cartucho::get_chr_bancos(bool espelhado) const
+    {
+        return espelhado ? this->chr_bancos_espelhados : this->chr_bancos;
+    }
+
+    const vector<byte>& Cartucho::get_chr_memoria() const
+    {
+        return this->possui_chr_ram ? this->ram_chr : this->rom_chr;
+    }
+
+    void Cartucho::decodificar_chr()
+    {
+        const uint32 tamanho = this->get_chr_memoria().size() & ~0x0F;
+        this->chr_linhas.assign(tamanho / 2, 0);
+        this->chr_linhas_espelhadas.assign(tamanho / 2, 0);
+
+        for (uint32 posicao = 0; posicao < tamanho; posicao += 16)
+        {
+            for (uint32 linha = 0; linha < 8; linha++)
+            {
+                this->decodificar_chr_linha(posicao + linha);
+            }
+        }
+    }
+
+    void Cartucho::decodificar_chr_linha(uint32 posicao)
+    {
+        // as linhas usam 2 bytes separados por 8 posições
+        posicao &= ~0x08;
+        const vector<byte>& memoria = this->get_chr_memoria();
+        if (posicao + 8 >= memoria.size())
+        {
+            return;
+        }
+
+        byte menor = memoria[posicao];
+        byte maior = memoria[posicao + 8];
+
+        uint32 valor = 0;
+        uint32 espelhado = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            uint32 pixel = ((menor >> (7 - i)) & 1) | (((maior >> (7 - i)) & 1) << 1);
+            valor |= pixel << ((7 - i) * 4);
+            espelhado |= pixel << (i * 4);
+        }
+
+        const uint32 indice = ((posicao & ~0x0F) >> 1) | (posicao & 0x07);
+        this->chr_linhas[indice] = valor;
+        this->chr_linhas_espelhadas[indice] = espelhado;
+    }
+
+    void Cartucho::mapear_chr_banco(int janela, int banco)
+    {
+        const int bancos_qtd = this->chr_linhas.size() / CHR_BANCO_LINHAS;
+        if (bancos_qtd == 0)
+        {
+            return;
+        }
+
+        const int inicio = (banco % bancos_qtd) * CHR_BANCO_LINHAS;
+        this->chr_bancos.at(janela) = &this->chr_linhas[inicio];
+        this->chr_bancos_espelhados.at(janela) = &this->chr_linhas_espelhadas[inicio];
+
+        if (this->chr_alterado)
+        {
+            this->chr_alterado();
+        }
+    }
 }
\ No newline at end of file
@@ -20,7 +20,9 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <memory>
+#include <functional>
 
 #include "tipos_numeros.hpp"
 
@@ -28,7 +30,9 @@ namespace nesbrasa::nucleo::mapeadores
 {
     using std::string;
     using std::vector;
+    using std::array;
     using std::unique_ptr;
+    using std::function;
     using namespace tipos;
 
     enum class CartuchoTipo
@@ -61,12 +65,36 @@ namespace nesbrasa::nucleo::mapeadores
         vector<byte> rom_chr;
         vector<byte> ram_prg;
         vector<byte> ram_chr;
+
+        // linhas dos tiles de toda a memória CHR já decodificadas, com os 8 pixels
+        // guardados em 4 bits cada e o primeiro pixel nos bits mais significativos.
+        // O pixel usa os 2 bits menores, no mesmo formato dos dados de tiles da ppu
+        vector<uint32> chr_linhas;
+        // as mesmas linhas espelhadas horizontalmente, usadas pelos sprites
+        vector<uint32> chr_linhas_espelhadas;
+        // início das linhas decodificadas de cada banco de 1KiB mapeado na ppu
+        array<const uint32*, 8> chr_bancos;
+        array<const uint32*, 8> chr_bancos_espelhados;
     
     public:
         ArquivoFormato arquivo_formato;
 
         byte espelhamento;
 
+        /*! Função chamada pelo mapeador sempre que os bancos mapeados
+            na memória da cpu forem alterados */
+        function<void()> mapeamento_alterado;
+
+        /*! Função chamada pelo mapeador sempre que 'espelhamento' for alterado */
+        function<void()> espelhamento_alterado;
+
+        /*! Função chamada pelo mapeador sempre que os bancos CHR mapeados
+            na memória da ppu forem alterados */
+        function<void()> chr_alterado;
+
+        // quantidade de linhas de tiles em um banco CHR de 1KiB
+        static const int CHR_BANCO_LINHAS = 0x200;
+
         // tamanho em bytes de um banco da ROM PRG
         static const int PRG_BANCOS_TAMANHO;
         // tamanho em bytes de um banco da ROM CHR
@@ -88,7 +116,41 @@ namespace nesbrasa::nucleo::mapeadores
 
         virtual string get_nome() = 0;
 
+        /*! Busca os 256 bytes mapeados a partir de um endereço da cpu, usados 
+            para montar a tabela de páginas da memória.
+            \return Um ponteiro para o início da página, ou nullptr caso as
+                    leituras nessa página precisem passar pelo método 'ler'
+        */
+        virtual const byte* get_pagina(uint16 endereco);
+
+        /*! Linhas decodificadas dos 8 bancos CHR de 1KiB mapeados em $0000-$1FFF,
+            com 'CHR_BANCO_LINHAS' linhas cada, ou nullptr nas janelas sem banco.
+            Os ponteiros continuam válidos enquanto o cartucho existir
+            \param espelhado Busca as linhas espelhadas horizontalmente
+        */
+        const array<const uint32*, 8>& get_chr_bancos(bool espelhado) const;
+
         int get_prg_bancos_quantidade();
         int get_chr_bancos_quantidade();
+
+    protected:
+        //! Memória CHR do cartucho, a RAM CHR caso ela exista e a ROM CHR caso contrário
+        const vector<byte>& get_chr_memoria() const;
+
+        /*! Decodifica todas as linhas da memória CHR, deve ser chamado depois da
+            alocação da memória CHR. A troca de bancos não precisa de uma nova decodificação */
+        void decodificar_chr();
+
+        /*! Decodifica a linha que contém a posição, deve ser chamado nas escritas na RAM CHR
+            \param posicao Posição do byte escrito em 'get_chr_memoria'
+        */
+        void decodificar_chr_linha(uint32 posicao);
+
+        /*! Mapeia um banco de 1KiB da memória CHR em uma das 8 janelas da ppu
+            e chama 'chr_alterado'
+            \param janela Janela da memória da ppu ($0000 + janela*$400)
+            \param banco Índice do banco de 1KiB, espelhado pela quantidade de bancos
+        */
+        void mapear_chr_banco(int janela, int banco);
     };
 }
\ No newline at end of file
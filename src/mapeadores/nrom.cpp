@@ -39,6 +39,12 @@ namespace nesbrasa::nucleo::mapeadores
             // aloca a memória que representará a ram CHR
             this->ram_chr.resize(0x2000);
         }
+
+        this->decodificar_chr();
+        for (int janela = 0; janela < 8; janela++)
+        {
+            this->mapear_chr_banco(janela, janela);
+        }
     }
 
     uint8_t NRom::ler(uint16 endereco)
@@ -83,8 +89,9 @@ namespace nesbrasa::nucleo::mapeadores
 
         if (endereco < 0x2000)
         {
-            // escrever na rom CHR
-            this->rom_chr.at(endereco) = valor;
+            // escrever na ram CHR
+            this->ram_chr.at(endereco) = valor;
+            this->decodificar_chr_linha(endereco);
         }
     }
 
@@ -92,4 +99,27 @@ namespace nesbrasa::nucleo::mapeadores
     {
         return "NROM";
     }
+
+    const byte* NRom::get_pagina(uint16 endereco)
+    {
+        if (endereco < 0x8000)
+        {
+            return nullptr;
+        }
+
+        uint16 endereco_mapeado = endereco - 0x8000;
+
+        // espelhar o endereço caso a rom PRG só possua 1 banco
+        if (this->prg_bancos_quantidade == 1)
+        {
+            endereco_mapeado %= 0x4000;
+        }
+
+        if (static_cast<size_t>(endereco_mapeado) + 0x100 > this->rom_prg.size())
+        {
+            return nullptr;
+        }
+
+        return &this->rom_prg[endereco_mapeado];
+    }
 }
\ No newline at end of file
@@ -36,5 +36,7 @@ namespace nesbrasa::nucleo::mapeadores
 		void escrever(uint16 endereco, byte valor) override;
 
 		string get_nome() override;
+
+		const byte* get_pagina(uint16 endereco) override;
 	};
 }
@@ -16,75 +16,62 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <sstream>
-#include <iostream>
-
 #include "memoria.hpp"
 #include "nesbrasa.hpp"
 
 namespace nesbrasa::nucleo
 {
-    using std::stringstream;
-    using std::runtime_error;
-
     Memoria::Memoria(Nes *nes):
-        ram({ 0 })
+        ram({ 0 }),
+        ram_codigo({ false })
     {
         this->nes = nes;
-    }
 
-    byte Memoria::ler(uint16 endereco)
-    {
-        if (endereco <= 0x07FF)
-        {
-            return this->ram.at(endereco);
-        }
-        else if (endereco >= 0x0800 && endereco <=0x1FFF)
-        {
-            // endereços nesta area são espelhos dos endereços
-            // localizados entre 0x0000 e 0x07FF
-            return this->ram.at(endereco % 0x0800);
-        }
-        else if (endereco >= 0x2000 && endereco <= 0x2007)
-        {
-            return this->nes->ppu.registrador_ler(endereco);
-        }
-        else if (endereco >= 0x2008 && endereco <= 0x3FFF)
-        {
-            // endereço espelhado do registrador
-            uint16 ender_espelhado = (endereco%0x8) + 0x2000;
-            return this->nes->ppu.registrador_ler(ender_espelhado);
-        }
-        else if (endereco >= 0x4000 && endereco <= 0x4015)
-        {
-            // TODO: registradores da APU
-            return 0;
-        }
-        else if (endereco == 0x4016)
-        {
-            return this->nes->controle_1.ler();
-        }
-        else if (endereco == 0x4017)
+        this->paginas_leitura.fill(nullptr);
+        this->paginas_escrita.fill(nullptr);
+        this->mapear_ram();
+
+        this->paginas_regiao.fill(MemoriaRegiao::CARTUCHO);
+        for (uint pagina = 0x00; pagina <= 0x1F; pagina++)
         {
-            return this->nes->controle_2.ler();
+            this->paginas_regiao.at(pagina) = MemoriaRegiao::RAM;
         }
-        else if (endereco >= 0x4018 && endereco <= 0x401F)
+        for (uint pagina = 0x20; pagina <= 0x3F; pagina++)
         {
-            // endereços não útilizados 
-            return 0;
+            this->paginas_regiao.at(pagina) = MemoriaRegiao::PPU;
         }
-        else if (endereco >= 0x4020 && endereco <= 0xFFFF)
+        this->paginas_regiao.at(0x40) = MemoriaRegiao::ENTRADA_SAIDA;
+    }
+
+    byte Memoria::ler_mmio(uint16 endereco)
+    {
+        // as páginas da RAM sempre têm ponteiro de leitura, então não chegam aqui
+        switch (this->paginas_regiao[endereco >> 8])
         {
-            return this->nes->cartucho->ler(endereco);
-        }
+            case MemoriaRegiao::PPU:
+                // $2008-$3FFF são espelhos dos registradores
+                return this->nes->ppu.registrador_ler(0x2000 | (endereco & 0x7));
+
+            case MemoriaRegiao::ENTRADA_SAIDA:
+                if (endereco == 0x4016)
+                {
+                    return this->nes->controle_1.ler();
+                }
+                else if (endereco == 0x4017)
+                {
+                    return this->nes->controle_2.ler();
+                }
+                else if (endereco >= 0x4020)
+                {
+                    return this->nes->cartucho->ler(endereco);
+                }
 
-        // endereço não existe, lançar erro
-        stringstream erro_ss;
-        erro_ss << "Tentativa de leitura em um endereço não existente na memória";
-        erro_ss << " (" << std::hex << endereco << ") ";
-        erro_ss << endereco;
+                // TODO: registradores da APU, $4018-$401F não são utilizados
+                return 0;
 
-        throw runtime_error(erro_ss.str());
+            default:
+                return this->nes->cartucho->ler(endereco);
+        }
     }
 
     uint16 Memoria::ler_16_bits(uint16 endereco)
@@ -112,63 +99,116 @@ namespace nesbrasa::nucleo
         return (maior << 8) | menor;
     }
 
-    void Memoria::escrever(uint16 endereco, byte valor)
+    void Memoria::escrever_mmio(uint16 endereco, byte valor)
     {
-        if (endereco <= 0x07FF)
-        {
-            this->ram.at(endereco) = valor;
-        }
-        else if (endereco >= 0x0800 && endereco <=0x1FFF)
+        switch (this->paginas_regiao[endereco >> 8])
         {
-            // endereços nesta area são espelhos dos endereços
-            // localizados entre 0x0000 e 0x07FF
-            this->ram.at(endereco % 0x0800) = valor;
-        }
-        else if (endereco >= 0x2000 && endereco <= 0x2007)
-        {
-            this->nes->ppu.registrador_escrever(nes, endereco, valor);
+            case MemoriaRegiao::RAM:
+                // endereços entre 0x0800 e 0x1FFF são espelhos da RAM
+                this->escrever_ram(endereco % 0x0800, valor);
+                break;
+
+            case MemoriaRegiao::PPU:
+                // $2008-$3FFF são espelhos dos registradores
+                this->nes->ppu.registrador_escrever(nes, 0x2000 | (endereco & 0x7), valor);
+                break;
+
+            case MemoriaRegiao::ENTRADA_SAIDA:
+                if (endereco == 0x4016)
+                {
+                    this->nes->controle_1.escrever(valor);
+                    this->nes->controle_2.escrever(valor);
+                }
+                else if (endereco >= 0x4020)
+                {
+                    this->nes->cartucho->escrever(endereco, valor);
+                }
+
+                // TODO: registradores da APU, $4018-$401F não são utilizados
+                break;
+
+            case MemoriaRegiao::CARTUCHO:
+                this->nes->cartucho->escrever(endereco, valor);
+                break;
         }
-        else if (endereco >= 0x2008 && endereco <= 0x3FFF)
+    }
+
+    void Memoria::cpu_ativar_interrupcao(Interrupcao interrupcao)
+    {
+        this->nes->cpu.interrupcao = interrupcao;
+    }
+
+    void Memoria::marcar_ram_codigo(uint16 endereco)
+    {
+        bool& trecho = this->ram_codigo.at((endereco % 0x0800) / 0x40);
+        if (!trecho)
         {
-            // endereço espelhado do registrador
-            uint16 ender_espelhado = (endereco%0x8) + 0x2000;
-            this->nes->ppu.registrador_escrever(nes, ender_espelhado, valor);
+            trecho = true;
+            this->mapear_ram();
         }
-        else if (endereco >= 0x4000 && endereco <= 0x4017)
+    }
+
+    void Memoria::limpar_ram_codigo()
+    {
+        this->ram_codigo.fill(false);
+        this->mapear_ram();
+    }
+
+    void Memoria::mapear_cartucho()
+    {
+        // a página 0x40 também contém os registradores da APU e dos controles
+        for (uint pagina = 0x41; pagina <= 0xFF; pagina++)
         {
-            if (endereco == 0x4016)
+            this->paginas_escrita.at(pagina) = nullptr;
+            
+            if (this->nes->cartucho != nullptr)
             {
-                this->nes->controle_1.escrever(valor);
-                this->nes->controle_2.escrever(valor);
+                this->paginas_leitura.at(pagina) = this->nes->cartucho->get_pagina(pagina << 8);
             }
-            else 
+            else
             {
-                // TODO: registradores da APU
+                this->paginas_leitura.at(pagina) = nullptr;
             }
         }
-        else if (endereco >= 0x4018 && endereco <= 0x401F)
-        {
-            // endereços não útilizados
-            return;
-        }
-        else if (endereco >= 0x4020 && endereco <= 0xFFFF)
-        {
-            this->nes->cartucho->escrever(endereco, valor);
-        }
-        else
+    }
+
+    const array<byte, 0x0800>& Memoria::get_ram()
+    {
+        return this->ram;
+    }
+
+    void Memoria::set_ram(const array<byte, 0x0800>& ram)
+    {
+        this->ram = ram;
+    }
+
+    void Memoria::mapear_ram()
+    {
+        // a RAM ocupa as páginas 0x00 a 0x07 e é espelhada até a página 0x1F
+        for (uint pagina = 0x00; pagina <= 0x1F; pagina++)
         {
-            // endereço não existe, lançar erro
-            stringstream erro_ss;
-            erro_ss << "Tentativa de escrita do valor " << std::hex << valor;
-            erro_ss << " em um endereço não existente na memória";
-            erro_ss << " (" << std::hex << endereco << ")";
+            byte* ponteiro = &this->ram.at((pagina % 0x08) << 8);
+            this->paginas_leitura.at(pagina) = ponteiro;
 
-            throw runtime_error(erro_ss.str());
+            // as escritas em páginas com código guardado no cache
+            // de blocos vão pelo caminho lento, para invalidar os blocos
+            bool possui_codigo = false;
+            for (uint trecho = 0; trecho < 0x100 / 0x40; trecho++)
+            {
+                possui_codigo |= this->ram_codigo.at((pagina % 0x08) * (0x100 / 0x40) + trecho);
+            }
+
+            this->paginas_escrita.at(pagina) = possui_codigo ? nullptr : ponteiro;
         }
     }
 
-    void Memoria::cpu_ativar_interrupcao(Interrupcao interrupcao)
+    void Memoria::escrever_ram(uint16 endereco, byte valor)
     {
-        this->nes->cpu.interrupcao = interrupcao;
+        this->ram.at(endereco) = valor;
+
+        if (this->ram_codigo[endereco / 0x40])
+        {
+            this->nes->cpu.invalidar_blocos_ram(endereco);
+        }
     }
 }
\ No newline at end of file
@@ -31,10 +31,35 @@ namespace nesbrasa::nucleo
     class Nes;
     enum class Interrupcao;
 
+    //! Destino dos acessos às páginas que passam pelo caminho lento da memória
+    enum class MemoriaRegiao : byte
+    {
+        // RAM interna e seus espelhos, só usada nas escritas em trechos com código
+        RAM,
+        // registradores da ppu em $2000-$2007 e seus espelhos
+        PPU,
+        // registradores da APU e dos controles em $4000-$401F, o resto da página é do cartucho
+        ENTRADA_SAIDA,
+        CARTUCHO,
+    };
+
     class Memoria
     {
     private:
         array<byte, 0x0800> ram; 
+
+        // trechos da RAM que contêm código guardado no cache de blocos da cpu,
+        // as escritas nesses trechos precisam invalidar os blocos
+        array<bool, 0x0800 / 0x40> ram_codigo;
+
+        // tabelas com um ponteiro para cada página de 256 bytes do espaço de endereços
+        // da cpu, as páginas sem ponteiro são acessadas através dos registradores 
+        // mapeados na memória (MMIO) ou do cartucho
+        array<const byte*, 0x100> paginas_leitura;
+        array<byte*, 0x100> paginas_escrita;
+
+        // região de cada página, consultada quando a página não tem ponteiro na tabela
+        array<MemoriaRegiao, 0x100> paginas_regiao;
         
     public:        
         Nes* nes;
@@ -42,7 +67,16 @@ namespace nesbrasa::nucleo
         Memoria(Nes* nes);
 
         //! Lê um valor de 8 bits na memoria
-        byte ler(uint16 endereco);
+        inline byte ler(uint16 endereco)
+        {
+            const byte* pagina = this->paginas_leitura[endereco >> 8];
+            if (pagina != nullptr)
+            {
+                return pagina[endereco & 0xFF];
+            }
+
+            return this->ler_mmio(endereco);
+        }
 
         //! Lê um valor de 16 bits na memoria
         uint16 ler_16_bits(uint16 endereco);
@@ -51,8 +85,46 @@ namespace nesbrasa::nucleo
         uint16 ler_16_bits_bug(uint16 endereco);
 
         //! Escreve um valor na memoria
-        void escrever(uint16 endereco, byte valor);
+        inline void escrever(uint16 endereco, byte valor)
+        {
+            byte* pagina = this->paginas_escrita[endereco >> 8];
+            if (pagina != nullptr)
+            {
+                pagina[endereco & 0xFF] = valor;
+                return;
+            }
+
+            this->escrever_mmio(endereco, valor);
+        }
 
         void cpu_ativar_interrupcao(Interrupcao interrupcao);
+
+        //! Marca o trecho da RAM que contém o endereço como um trecho com código
+        void marcar_ram_codigo(uint16 endereco);
+
+        //! Desmarca todos os trechos da RAM que continham código
+        void limpar_ram_codigo();
+
+        //! Atualiza as páginas do cartucho, deve ser chamado quando os bancos do mapeador forem alterados
+        void mapear_cartucho();
+
+        //! Conteúdo da RAM interna
+        const array<byte, 0x0800>& get_ram();
+
+        /*! Substitui o conteúdo da RAM interna sem passar pelas escritas normais,
+            então não invalida o código guardado no cache de blocos da cpu */
+        void set_ram(const array<byte, 0x0800>& ram);
+
+    private:
+        //! Leitura pelo caminho lento, usada nas páginas sem ponteiro na tabela
+        byte ler_mmio(uint16 endereco);
+
+        //! Escrita pelo caminho lento, usada nas páginas sem ponteiro na tabela
+        void escrever_mmio(uint16 endereco, byte valor);
+
+        void escrever_ram(uint16 endereco, byte valor);
+
+        //! Atualiza as páginas da RAM e dos seus espelhos
+        void mapear_ram();
     };
 }
\ No newline at end of file
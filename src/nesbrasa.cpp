@@ -16,9 +16,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <limits>
 
 #include "nesbrasa.hpp"
 #include "mapeadores/nrom.hpp"
@@ -39,11 +41,15 @@ namespace nesbrasa::nucleo
     {
         this->is_programa_carregado = false;
         this->cartucho = nullptr;
+        this->pular_lacos_espera = true;
     }
 
     void Nes::carregar_rom(vector<byte> arquivo)
     {
+        this->ppu.mapear_chr_bancos({}, {});
         this->cartucho = nullptr;
+        this->memoria.mapear_cartucho();
+        this->cpu.set_programa_estatico(nullptr);
         this->is_programa_carregado = false;
         auto formato = ArquivoFormato::DESCONHECIDO;
 
@@ -96,25 +102,176 @@ namespace nesbrasa::nucleo
         // Usar o método factory da classe Cartucho para criar o objeto do cartucho
         this->cartucho = Cartucho::criar(cartucho_tipo, prg_qtd, chr_qtd, arquivo, formato, espelhamento);
 
+        // remapear as páginas da memória e descartar o código decodificado
+        // sempre que o mapeador trocar os bancos
+        this->cartucho->mapeamento_alterado = [this]()
+        {
+            this->memoria.mapear_cartucho();
+            this->cpu.invalidar_blocos();
+        };
+        this->cartucho->espelhamento_alterado = [this]()
+        {
+            this->ppu.mapear_tabelas_de_nomes(this->cartucho->espelhamento);
+        };
+        this->cartucho->chr_alterado = [this]()
+        {
+            this->ppu.mapear_chr_bancos(this->cartucho->get_chr_bancos(false), 
+                                        this->cartucho->get_chr_bancos(true));
+        };
+        this->memoria.mapear_cartucho();
+        this->ppu.mapear_tabelas_de_nomes(this->cartucho->espelhamento);
+        this->cartucho->chr_alterado();
+
         //TODO: Completar suporte a ROMs no formato NES 2.0
         this->is_programa_carregado = true;
         this->cpu.resetar();
     }
 
     int Nes::avancar()
+    {
+        this->checar_programa_carregado();
+
+        return this->executar(std::numeric_limits<uint32>::max());
+    }
+
+    NesExecucao Nes::executar_ciclos(uint32 ciclos)
+    {
+        this->checar_programa_carregado();
+
+        uint32 executados = 0;
+        while (executados < ciclos)
+        {
+            executados += this->executar_lote(ciclos - executados);
+        }
+
+        return { executados, executados - ciclos };
+    }
+
+    NesExecucao Nes::executar_frame()
+    {
+        this->checar_programa_carregado();
+
+        // cada ciclo avança 3 pontos, então o limite de cada chamada termina no máximo
+        // na instrução em que o vblank começa, mesmo dentro de um laço de espera
+        const uint64 frame = this->ppu.get_frames_completos();
+        uint32 executados = 0;
+        while (this->ppu.get_frames_completos() == frame)
+        {
+            const uint32 limite = std::max<uint32>(this->ppu.pontos_ate_vblank() / 3, 1);
+            executados += this->executar_lote(limite);
+        }
+
+        return { executados, this->ppu.pontos_desde_vblank() / 3 };
+    }
+
+    void Nes::set_pular_lacos_espera(bool pular)
+    {
+        this->pular_lacos_espera = pular;
+    }
+
+    void Nes::checar_programa_carregado()
     {
         if (!this->is_programa_carregado)
         {
             throw runtime_error("Erro: nenhum programa na memória"s);
         }
+    }
 
-        const int cpu_ciclos = this->cpu.avancar();
-        const int ppu_ciclos = cpu_ciclos * 3;
-        for (int i = 0; i < ppu_ciclos; i++)
+    int Nes::executar(uint32 ciclos_limite)
+    {
+        const Bloco* laco = this->pular_lacos_espera ? this->cpu.buscar_laco_espera() : nullptr;
+        if (laco != nullptr)
         {
-            this->ppu.avancar();
+            return this->avancar_laco_espera(*laco, ciclos_limite);
         }
 
+        return this->passo(ciclos_limite);
+    }
+
+    uint32 Nes::executar_lote(uint32 ciclos_limite)
+    {
+        const Bloco* laco = this->pular_lacos_espera ? this->cpu.buscar_laco_espera() : nullptr;
+        if (laco != nullptr)
+        {
+            return this->avancar_laco_espera(*laco, ciclos_limite);
+        }
+
+        return this->cpu.executar_ciclos(ciclos_limite, this->pular_lacos_espera);
+    }
+
+    int Nes::passo(uint32 ciclos_limite)
+    {
+        const int cpu_ciclos = this->cpu.avancar(ciclos_limite);
+        this->ppu.adiar_pontos(cpu_ciclos * 3);
+
         return cpu_ciclos;
     }
+
+    int Nes::avancar_laco_espera(const Bloco& laco, uint32 ciclos_limite)
+    {
+        // o laço só pode ser pulado enquanto os valores lidos por ele não mudarem,
+        // a ram só muda com uma interrupção e o PPUSTATUS depende da ppu
+        uint32 pontos_limite = 0;
+        if (laco.espera == BlocoEspera::PPU_ESTADO)
+        {
+            pontos_limite = this->ppu.pontos_estado_estavel();
+        }
+        else
+        {
+            pontos_limite = this->ppu.pontos_ate_vblank();
+        }
+
+        // as repetições também não podem passar do limite de ciclos pedido
+        if (ciclos_limite < pontos_limite / 3)
+        {
+            pontos_limite = ciclos_limite * 3;
+        }
+
+        const byte a = this->cpu.a;
+        const byte x = this->cpu.x;
+        const byte y = this->cpu.y;
+        const byte sp = this->cpu.sp;
+        const byte estado = this->cpu.get_estado();
+
+        // executar uma repetição normalmente, guardando os ciclos de cada instrução.
+        // A repetição para no limite de ciclos, como a execução sem os laços pulados
+        array<int, BlocoCache::BLOCO_TAMANHO_MAXIMO> ciclos;
+        uint32 total = 0;
+        for (size_t i = 0; i < laco.instrucoes.size(); i++)
+        {
+            if (this->cpu.pc != laco.instrucoes[i].pc || this->cpu.interrupcao != Interrupcao::NENHUMA ||
+                total >= ciclos_limite)
+            {
+                return total;
+            }
+
+            ciclos[i] = this->passo(ciclos_limite - total);
+            total += ciclos[i];
+        }
+
+        // as próximas repetições só serão iguais se esta não tiver alterado a cpu
+        if (this->cpu.pc != laco.inicio || this->cpu.a != a || this->cpu.x != x || 
+            this->cpu.y != y || this->cpu.sp != sp || this->cpu.get_estado() != estado)
+        {
+            return total;
+        }
+
+        // repetir apenas a contagem de ciclos de cada instrução até ocorrer uma
+        // interrupção ou até a ppu chegar em um ponto que pode alterar o laço
+        uint32 pontos = total * 3;
+        uint32 ciclos_pulados = 0;
+        size_t indice = 0;
+        while (this->cpu.interrupcao == Interrupcao::NENHUMA && 
+               pontos + ciclos[indice]*3 <= pontos_limite)
+        {
+            this->ppu.adiar_pontos(ciclos[indice]*3);
+
+            pontos += ciclos[indice]*3;
+            ciclos_pulados += ciclos[indice];
+            indice = (indice + 1) % laco.instrucoes.size();
+        }
+
+        this->cpu.pular_laco_espera(&laco, indice, ciclos_pulados);
+        return total + ciclos_pulados;
+    }
 }
\ No newline at end of file
@@ -36,6 +36,13 @@ namespace nesbrasa::nucleo
     using std::unique_ptr;
     using namespace mapeadores;
 
+    //! Resultado das execuções em lote
+    struct NesExecucao
+    {
+        uint32 ciclos;    // quantidade de ciclos da cpu que foram executados
+        uint32 excedente; // ciclos executados depois do limite pedido, já que a última instrução não é interrompida
+    };
+
     class Nes
     {
     public:
@@ -54,6 +61,48 @@ namespace nesbrasa::nucleo
         Nes();
 
         void carregar_rom(vector<byte> arquivo);
+
+        /*! Executa a próxima instrução da cpu e os ciclos correspondentes da ppu.
+            Caso a cpu esteja em um laço de espera, as repetições que não podem alterar
+            o estado do console são puladas de uma vez. Os ciclos da ppu são adiados
+            até o próximo ponto em que a cpu pode observá-los
+            \return Quantidade de ciclos da cpu que foram executados
+        */
         int avancar();
+
+        /*! Executa instruções até completar a quantidade de ciclos da cpu pedida.
+            Os laços de espera pulados e os blocos de código nativo não passam do limite,
+            então a execução para depois da mesma instrução que executando uma por vez
+            \return Os ciclos executados e quantos passaram do limite
+        */
+        NesExecucao executar_ciclos(uint32 ciclos);
+
+        /*! Executa instruções até o fim do frame atual, no início do próximo vblank
+            \return Os ciclos executados e quantos foram executados depois do início do vblank
+        */
+        NesExecucao executar_frame();
+
+        /*! Define se os laços de espera são pulados de uma vez. Os resultados são os mesmos
+            nos dois casos, desabilitar serve apenas para comparar com a execução normal
+        */
+        void set_pular_lacos_espera(bool pular);
+
+    private:
+        bool pular_lacos_espera;
+
+        void checar_programa_carregado();
+
+        //! Executa uma instrução ou pula um laço de espera, sem passar do limite de ciclos
+        int executar(uint32 ciclos_limite);
+
+        /*! Pula o laço de espera do pc ou executa as instruções seguintes de uma vez na cpu,
+            que para no início do próximo laço de espera
+        */
+        uint32 executar_lote(uint32 ciclos_limite);
+
+        //! Executa uma instrução da cpu e adia os ciclos correspondentes da ppu
+        int passo(uint32 ciclos_limite);
+
+        int avancar_laco_espera(const Bloco& laco, uint32 ciclos_limite);
     };
 }
\ No newline at end of file
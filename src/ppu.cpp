@@ -10,7 +10,10 @@
 #include "memoria.hpp"
 #include "util.hpp"
 #include "cores.hpp"
-#include <iostream>
+#include "compositor.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
 
 namespace nesbrasa::nucleo
 {
@@ -25,25 +28,165 @@ namespace nesbrasa::nucleo
         array<uint16, 4> {0, 1, 2, 3},
     };
 
+    // ações que podem ser executadas em um ponto
+    enum PontoAcao : uint16
+    {
+        ACAO_LINHA_INICIAR   = 1 << 0,
+        ACAO_PIXEL           = 1 << 1,  // desenhar um pixel, apenas nos pontos visíveis
+        ACAO_DESLOCAR        = 1 << 2,  // deslocar os pixels dos tiles do fundo
+        ACAO_BUSCAR_NOME     = 1 << 3,
+        ACAO_BUSCAR_ATRIBUTO = 1 << 4,
+        ACAO_BUSCAR_MENOR    = 1 << 5,
+        ACAO_BUSCAR_MAIOR    = 1 << 6,
+        ACAO_GUARDAR_TILE    = 1 << 7,
+        ACAO_SCROLL_X        = 1 << 8,
+        ACAO_SCROLL_Y        = 1 << 9,
+        ACAO_COPIAR_X        = 1 << 10,
+        ACAO_COPIAR_Y        = 1 << 11,
+        ACAO_AVALIAR_SPRITES = 1 << 12,
+        ACAO_LIMPAR_SPRITES  = 1 << 13,
+        ACAO_VBLANK_INICIAR  = 1 << 14,
+        ACAO_VBLANK_ENCERRAR = 1 << 15,
+
+        ACAO_BUSCAS = ACAO_BUSCAR_NOME | ACAO_BUSCAR_ATRIBUTO | ACAO_BUSCAR_MENOR | 
+                      ACAO_BUSCAR_MAIOR | ACAO_GUARDAR_TILE,
+    };
+
+    // tipos de scanline com ações diferentes
+    enum LinhaTipo : byte
+    {
+        LINHA_VISIVEL,        // 0-239
+        LINHA_PRE,            // 261
+        LINHA_VBLANK_INICIO,  // 241
+        LINHA_OCIOSA,         // 240 e 242-260
+    };
+
+    static constexpr array<byte, 262> criar_tabela_linhas()
+    {
+        array<byte, 262> tabela {};
+        for (int scanline = 0; scanline < 262; scanline++)
+        {
+            if (scanline < 240)
+                tabela[scanline] = LINHA_VISIVEL;
+            else if (scanline == 261)
+                tabela[scanline] = LINHA_PRE;
+            else if (scanline == 241)
+                tabela[scanline] = LINHA_VBLANK_INICIO;
+            else
+                tabela[scanline] = LINHA_OCIOSA;
+        }
+
+        return tabela;
+    }
+
+    static constexpr array<array<uint16, 341>, 4> criar_tabela_acoes()
+    {
+        array<array<uint16, 341>, 4> tabela {};
+        for (int tipo = 0; tipo < 4; tipo++)
+        {
+            const bool linha_visivel = tipo == LINHA_VISIVEL;
+            const bool prelinha = tipo == LINHA_PRE;
+            const bool linha_renderizacao = prelinha || linha_visivel;
+
+            for (int ciclo = 0; ciclo < 341; ciclo++)
+            {
+                const bool ciclo_pre_busca = ciclo >= 321 && ciclo <= 336;
+                const bool ciclo_visivel = ciclo >= 1 && ciclo <= 256;
+                const bool ciclo_busca = ciclo_pre_busca || ciclo_visivel;
+
+                uint16 acoes = 0;
+                if (ciclo == 0)
+                    acoes |= ACAO_LINHA_INICIAR;
+                if (linha_visivel && ciclo_visivel)
+                    acoes |= ACAO_PIXEL;
+
+                if (linha_renderizacao && ciclo_busca)
+                {
+                    acoes |= ACAO_DESLOCAR;
+                    switch (ciclo % 8)
+                    {
+                        case 1: acoes |= ACAO_BUSCAR_NOME; break;
+                        case 3: acoes |= ACAO_BUSCAR_ATRIBUTO; break;
+                        case 5: acoes |= ACAO_BUSCAR_MENOR; break;
+                        case 7: acoes |= ACAO_BUSCAR_MAIOR; break;
+                        case 0: acoes |= ACAO_GUARDAR_TILE | ACAO_SCROLL_X; break;
+                        default: break;
+                    }
+                }
+
+                if (prelinha && ciclo >= 280 && ciclo <= 304)
+                    acoes |= ACAO_COPIAR_Y;
+                if (linha_renderizacao && ciclo == 256)
+                    acoes |= ACAO_SCROLL_Y;
+                if (linha_renderizacao && ciclo == 257)
+                    acoes |= ACAO_COPIAR_X;
+
+                if (ciclo == 257)
+                    acoes |= linha_visivel ? ACAO_AVALIAR_SPRITES : ACAO_LIMPAR_SPRITES;
+
+                if (tipo == LINHA_VBLANK_INICIO && ciclo == 1)
+                    acoes |= ACAO_VBLANK_INICIAR;
+                if (prelinha && ciclo == 1)
+                    acoes |= ACAO_VBLANK_ENCERRAR;
+
+                tabela[tipo][ciclo] = acoes;
+            }
+        }
+
+        return tabela;
+    }
+
+    // ações de cada ponto, calculadas durante a compilação
+    static constexpr array<byte, 262> linhas_tipos = criar_tabela_linhas();
+    static constexpr array<array<uint16, 341>, 4> acoes_tabela = criar_tabela_acoes();
+
+    //! Ações executadas no ponto (scanline, ciclo)
+    static inline uint16 buscar_acoes(int scanline, int ciclo)
+    {
+        return acoes_tabela[linhas_tipos[scanline]][ciclo];
+    }
+
     Ppu::Ppu(Memoria* memoria): 
         memoria(memoria)
     {
+        // nenhum ponto foi adiado antes das chamadas a 'sincronizar' feitas abaixo
+        this->pontos_pendentes = 0;
+        this->pontos_horizonte = 0;
+
+        this->video = PpuVideo::COMPLETO;
+        this->frames_pular = 0;
+        this->frame_pulado = false;
+        this->atualizar_video_frame();
+        this->set_texturas(nullptr, nullptr);
+        this->set_texturas_indices(nullptr, nullptr);
+
         this->ciclo = 0;
         this->scanline = 261;
         this->frame = 0;
+        this->frames_completos = 0;
+        this->renderizacao = PpuRenderizacao::PONTO;
+        this->linha_ponto_a_ponto = false;
 
         this->buffer_dados = 0;
         this->ultimo_valor = 0;
         this->vram_incrementar = 0;
         this->oam_endereco = 0;
 
+        this->paletas.fill(0);
+        this->tabelas_de_nomes.fill(0);
+        this->oam.fill(0);
+        this->mapear_tabelas_de_nomes(0);
+        this->mapear_chr_bancos({}, {});
+
         this->tile_dados = 0;
-        this->tile_byte_maior = 0;
-        this->tile_byte_menor = 0;
+        this->tile_linha = 0;
         this->tabela_de_nomes_byte = 0;
         this->tabela_de_atributos_byte = 0;
 
         this->sprites_qtd = 0;
+        this->sprites_linha.fill(0);
+        this->sprites_linha_zero = false;
+        this->sprites_baldes_desatualizados = true;
 
         this->nmi_ocorreu = false;
         this->nmi_anterior = false;
@@ -65,6 +208,7 @@ namespace nesbrasa::nucleo
         this->flag_sprite_habilitar_col_esquerda = false;
         this->flag_fundo_habilitar_col_esquerda = false;
         this->flag_escala_cinza = false;
+        this->atualizar_paleta_rgb();
 
         this->flag_sprite_zero = false;
         this->flag_sprite_transbordamento = false;
@@ -131,108 +275,334 @@ namespace nesbrasa::nucleo
     {
         this->atualizar();
 
+        const uint16 acoes = buscar_acoes(this->scanline, this->ciclo);
         bool renderizacao_habilitada = this->flag_fundo_habilitar || this->flag_sprite_habilitar;
-        bool prelinha = this->scanline == 261;
-        bool linha_visivel = this->scanline < 240;
-        bool linha_renderizacao = prelinha || linha_visivel;
-        bool ciclo_pre_busca = this->ciclo >= 321 && this->ciclo <= 336;
-        bool ciclo_visivel = this->ciclo >= 1 && this->ciclo <= 256;
-        bool ciclo_busca = ciclo_pre_busca || ciclo_visivel;
+
+        if (acoes & ACAO_LINHA_INICIAR)
+        {
+            this->linha_ponto_a_ponto = false;
+        }
         
         // se a renderização estiver habilitada
         if (renderizacao_habilitada)
         {
-            if (linha_visivel && ciclo_visivel)
+            if (this->is_ponto_adiado())
             {
-                this->renderizar_pixel();
+                // os pontos visíveis da linha são executados de uma vez no último deles
+                if (this->ciclo == 256)
+                {
+                    this->renderizar_linha();
+                }
             }
-
-            if (linha_renderizacao && ciclo_busca)
+            else
             {
-                this->tile_dados <<= 4;
+                this->renderizar_ponto(acoes);
+            }
 
-                switch (this->ciclo % 8)
-                {
-                    case 1:
-                        // buscar byte da tabela de nomes
-                        this->buscar_byte_tabela_de_nomes();
-                        break;
-
-                    case 3:
-                        // buscar byte da tabela de atributos
-                        this->buscar_byte_tabela_de_atributos();
-                        break;
-
-                    case 5:
-                        // buscar o byte de menor significancia do tile
-                        this->buscar_tile_byte_menor();
-                        break;
-                        
-                    case 7:
-                        // buscar o byte de maior significancia do tile
-                        this->buscar_tile_byte_maior();
-                        break;
-                        
-                    case 0:
-                        // guardar os dados do tile
-                        this->tile_guardar_dados();
-                        break;
-
-                    default:
-                        break;
-                }
+            if (acoes & ACAO_AVALIAR_SPRITES)
+            {
+                this->avaliar_sprites();
             }
+            else if (acoes & ACAO_LIMPAR_SPRITES)
+            {
+                this->sprites_qtd = 0;
+                this->rasterizar_sprites();
+            }
+        }
 
-            if (prelinha && this->ciclo >= 280 && this->ciclo <= 304)
+        if (acoes & ACAO_VBLANK_INICIAR)
+        {
+            this->executar_ciclo_vblank();
+        }
+        if (acoes & ACAO_VBLANK_ENCERRAR)
+        {
+            this->encerrar_ciclo_vblank();
+            this->flag_sprite_zero = false;
+            this->flag_sprite_transbordamento = false;
+
+            // o próximo frame começa a ser desenhado na prelinha
+            this->frame_pulado = this->frames_pular > 0;
+            if (this->frame_pulado)
             {
-                this->copiar_y();
+                this->frames_pular -= 1;
             }
+            this->atualizar_video_frame();
+        }
+    }
 
-            if (linha_renderizacao)
+    void Ppu::sincronizar()
+    {
+        uint32 pontos = this->pontos_pendentes;
+        this->pontos_pendentes = 0;
+
+        this->avancar_pontos(pontos);
+    }
+
+    void Ppu::avancar_pontos(uint32 pontos)
+    {
+        while (pontos > 0)
+        {
+            uint32 salto = std::min(this->pontos_ociosos(), pontos);
+            if (salto == 0)
             {
-                if (ciclo_busca && this->ciclo%8 == 0)
-                {
-                    this->mudar_scroll_x();
-                }
+                this->avancar();
+                pontos -= 1;
+                continue;
+            }
 
-                if (this->ciclo == 256)
-                    this->mudar_scroll_y();
+            // o contador do NMI só chega a 0 no ponto seguinte ao salto
+            if (this->nmi_atrasar > 0)
+            {
+                this->nmi_atrasar -= salto;
+            }
 
-                if (this->ciclo == 257)
-                    this->copiar_x();
+            int posicao = this->scanline*341 + this->ciclo + salto;
+            if (this->ciclo + salto > 340)
+            {
+                this->linha_ponto_a_ponto = false;
             }
+            if (posicao >= 262*341)
+            {
+                posicao -= 262*341;
+                this->frame += 1;
+                this->f ^= 1;
+            }
+
+            this->scanline = posicao / 341;
+            this->ciclo = posicao % 341;
+            pontos -= salto;
         }
+    }
 
+    uint32 Ppu::pontos_ociosos()
+    {
+        const int atual = this->scanline*341 + this->ciclo;
+        const int vblank_inicio = 241*341 + 1;
+        const int vblank_fim = 261*341 + 1;
+
+        bool renderizacao_habilitada = this->flag_fundo_habilitar || this->flag_sprite_habilitar;
         if (renderizacao_habilitada)
         {
-            if (this->ciclo == 257)
+            // depois da limpeza dos sprites na linha 240 as únicas ações até a prelinha
+            // são o início do vblank e limpezas repetidas dos sprites, que não mudam nada.
+            // O ponto pulado dos frames ímpares fica fora desse intervalo
+            if (atual < 240*341 + 257 || atual >= vblank_fim || this->sprites_qtd != 0)
             {
-                if (linha_visivel)
-                {
-                    // avaliar sprites
-                    this->avaliar_sprites();
-                }
+                return 0;
+            }
+        }
+
+        // a renderização só pode ser reabilitada pela cpu, que sincroniza a ppu antes
+        int destino = atual < vblank_inicio ? vblank_inicio : vblank_fim;
+        if (atual >= vblank_fim)
+        {
+            destino = vblank_inicio + 262*341;
+        }
+
+        uint32 salto = destino - atual - 1;
+        if (this->nmi_atrasar > 0)
+        {
+            salto = std::min(salto, static_cast<uint32>(this->nmi_atrasar - 1));
+        }
+
+        return salto;
+    }
+
+    void Ppu::renderizar_ponto(uint16 acoes)
+    {
+        if (acoes & ACAO_PIXEL)
+        {
+            this->renderizar_pixel();
+        }
+
+        if (acoes & ACAO_DESLOCAR)
+        {
+            this->tile_dados <<= 4;
+
+            if ((acoes & ACAO_BUSCAS) && this->is_fundo_necessario())
+            {
+                if (acoes & ACAO_BUSCAR_NOME)
+                    this->buscar_byte_tabela_de_nomes();
+                else if (acoes & ACAO_BUSCAR_ATRIBUTO)
+                    this->buscar_byte_tabela_de_atributos();
+                else if (acoes & ACAO_BUSCAR_MENOR)
+                    this->buscar_tile_byte_menor();
+                else if (acoes & ACAO_BUSCAR_MAIOR)
+                    this->buscar_tile_byte_maior();
                 else
-                {
-                    this->sprites_qtd = 0;
-                }
+                    this->tile_guardar_dados();
+            }
+        }
+
+        if (acoes & ACAO_COPIAR_Y)
+            this->copiar_y();
+        if (acoes & ACAO_SCROLL_X)
+            this->mudar_scroll_x();
+        if (acoes & ACAO_SCROLL_Y)
+            this->mudar_scroll_y();
+        if (acoes & ACAO_COPIAR_X)
+            this->copiar_x();
+    }
+
+    bool Ppu::is_ponto_adiado()
+    {
+        return this->renderizacao == PpuRenderizacao::LINHA && !this->linha_ponto_a_ponto &&
+               (buscar_acoes(this->scanline, this->ciclo) & ACAO_PIXEL);
+    }
+
+    void Ppu::sincronizar_linha()
+    {
+        // no ponto 256 a linha já foi executada
+        if (!this->is_ponto_adiado() || this->ciclo == 256)
+        {
+            return;
+        }
+
+        // a renderização só pode ter sido habilitada ou desabilitada
+        // por uma escrita, que já teria sincronizado a linha
+        bool renderizacao_habilitada = this->flag_fundo_habilitar || this->flag_sprite_habilitar;
+        if (renderizacao_habilitada)
+        {
+            // refazer ponto a ponto os pontos adiados até o atual
+            const int ciclo = this->ciclo;
+            for (int i = 1; i <= ciclo; i++)
+            {
+                this->ciclo = i;
+                this->renderizar_ponto(buscar_acoes(this->scanline, i));
             }
+            this->ciclo = ciclo;
         }
 
-        if (this->scanline == 241 && this->ciclo == 1)
+        // o resto da linha é executado ponto a ponto, já que a cpu pode alterar a ppu
+        this->linha_ponto_a_ponto = true;
+    }
+
+    void Ppu::renderizar_linha()
+    {
+        // pixels de fundo da linha: os 2 tiles buscados no fim da linha anterior,
+        // que estão em 'tile_dados', e os 32 tiles buscados durante a linha
+        array<byte, 34*8> fundo_linha;
+        for (int i = 0; i < 16; i++)
         {
-            this->executar_ciclo_vblank();
+            fundo_linha[i] = static_cast<byte>((this->tile_dados >> (60 - i*4)) & 0x0F);
         }
-        if (prelinha && this->ciclo == 1)
+
+        const bool fundo_necessario = this->is_fundo_necessario();
+        for (int tile = 0; tile < 32; tile++)
         {
-            this->encerrar_ciclo_vblank();
-            this->flag_sprite_zero = false;
-            this->flag_sprite_transbordamento = false;
+            uint32 pixels = 0;
+            if (fundo_necessario)
+            {
+                this->buscar_byte_tabela_de_nomes();
+                this->buscar_byte_tabela_de_atributos();
+                this->buscar_tile_byte_menor();
+                this->buscar_tile_byte_maior();
+
+                uint32 atributos = this->tabela_de_atributos_byte;
+                pixels = this->tile_linha | atributos*0x11111111;
+                this->tile_linha = 0;
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                fundo_linha[16 + tile*8 + i] = static_cast<byte>((pixels >> (28 - i*4)) & 0x0F);
+            }
+
+            this->mudar_scroll_x();
+        }
+        this->mudar_scroll_y();
+
+        // no fim da linha ficam apenas os 2 últimos tiles buscados
+        this->tile_dados = 0;
+        for (int i = 256; i < 272; i++)
+        {
+            this->tile_dados = (this->tile_dados << 4) | fundo_linha[i];
+        }
+
+        if (!this->flag_fundo_habilitar)
+        {
+            fundo_linha.fill(0);
+        }
+
+        // os sprites da linha já foram desenhados em 'sprites_linha' por 'avaliar_sprites'
+        static const array<byte, 256> sprites_desabilitados {};
+        const byte* sprites = this->flag_sprite_habilitar ? this->sprites_linha.data()
+                                                          : sprites_desabilitados.data();
+
+        if (!this->is_imagem_produzida())
+        {
+            this->detectar_sprite_zero(fundo_linha.data() + this->x, sprites);
+            return;
+        }
+
+        // a paleta só pode ser alterada pela cpu, que sincronizaria a linha
+        bool sprite_zero = false;
+        if (this->video_frame == PpuVideo::INDICES)
+        {
+            uint16* pixels = this->indices_fundo->data() + this->scanline*256;
+            sprite_zero = compositor::compor_linha_indices(fundo_linha.data() + this->x, sprites, 
+                                                           this->paleta_indices, pixels,
+                                                           this->flag_fundo_habilitar_col_esquerda, 
+                                                           this->flag_sprite_habilitar_col_esquerda);
+        }
+        else
+        {
+            uint32* pixels = this->fundo->data() + this->scanline*256;
+            sprite_zero = compositor::compor_linha(fundo_linha.data() + this->x, sprites, 
+                                                   this->paleta_rgb, pixels,
+                                                   this->flag_fundo_habilitar_col_esquerda, 
+                                                   this->flag_sprite_habilitar_col_esquerda);
+        }
+        if (sprite_zero)
+        {
+            this->flag_sprite_zero = true;
         }
     }
 
+    void Ppu::detectar_sprite_zero(const byte* fundo_linha, const byte* sprites)
+    {
+        if (!this->sprites_linha_zero || this->flag_sprite_zero)
+        {
+            return;
+        }
+
+        // o sprite 0 não é detectado no último pixel da linha
+        for (int pos_x = 0; pos_x < 255; pos_x++)
+        {
+            byte fundo = fundo_linha[pos_x];
+            byte sprite = sprites[pos_x];
+            if (pos_x < 8 && !this->flag_fundo_habilitar_col_esquerda)
+                fundo = 0;
+            if (pos_x < 8 && !this->flag_sprite_habilitar_col_esquerda)
+                sprite = 0;
+
+            bool sprite_zero = false;
+            compositor::compor_pixel(fundo, sprite, sprite_zero);
+            if (sprite_zero)
+            {
+                this->flag_sprite_zero = true;
+                return;
+            }
+        }
+    }
+
+    bool Ppu::is_fundo_necessario()
+    {
+        if (this->video_frame != PpuVideo::SPRITE_ZERO)
+        {
+            return true;
+        }
+
+        // os tiles de uma linha começam a ser buscados no fim da linha anterior,
+        // depois que os sprites da linha já foram avaliados
+        return this->sprites_linha_zero && !this->flag_sprite_zero;
+    }
+
     byte Ppu::registrador_ler(uint16 endereco)
     {
+        this->sincronizar();
+        this->sincronizar_linha();
+
         switch (endereco)
         {
             case 0x2002:
@@ -251,6 +621,9 @@ namespace nesbrasa::nucleo
 
     void Ppu::registrador_escrever(Nes *nes, uint16 endereco, byte valor)
     {
+        this->sincronizar();
+        this->sincronizar_linha();
+
         this->ultimo_valor = valor;
         switch (endereco)
         {
@@ -297,11 +670,7 @@ namespace nesbrasa::nucleo
         }
         else if (endereco >= 0x2000 && endereco < 0x3F00)
         {
-            byte modo = nes->cartucho->espelhamento;
-            uint16 endereco_espelhado = this->endereco_espelhado(modo, endereco);
-            uint16 posicao = endereco_espelhado % this->tabelas_de_nomes.size();
-
-            return this->tabelas_de_nomes.at(posicao);
+            return this->tabelas_de_nomes_ponteiros[(endereco >> 10) & 3][endereco & 0x3FF];
         }
         else if (endereco >= 0x3F00 && endereco < 0x4000)
         {
@@ -325,11 +694,7 @@ namespace nesbrasa::nucleo
         }
         else if (endereco >= 0x2000 && endereco < 0x3F00)
         {
-            byte modo = nes->cartucho->espelhamento;
-            uint16 endereco_espelhado = this->endereco_espelhado(modo, endereco);
-            uint16 posicao = endereco_espelhado % this->tabelas_de_nomes.size();
-            
-            this->tabelas_de_nomes.at(posicao) = valor;
+            this->tabelas_de_nomes_ponteiros[(endereco >> 10) & 3][endereco & 0x3FF] = valor;
         }
         else if (endereco >= 0x3F00 && endereco < 0x4000)
         {
@@ -352,6 +717,35 @@ namespace nesbrasa::nucleo
             endereco -= 16;
 
         this->paletas.at(endereco) = valor;
+
+        // as entradas 0, 4, 8 e C também são lidas nos endereços das paletas dos sprites
+        this->atualizar_paleta_rgb(endereco);
+        if (endereco%4 == 0)
+            this->atualizar_paleta_rgb(endereco + 16);
+    }
+
+    void Ppu::atualizar_paleta_rgb()
+    {
+        for (uint16 i = 0; i < this->paleta_rgb.size(); i++)
+        {
+            this->atualizar_paleta_rgb(i);
+        }
+    }
+
+    void Ppu::atualizar_paleta_rgb(uint16 endereco)
+    {
+        byte cor = this->ler_paleta(endereco) % 64;
+        if (this->flag_escala_cinza)
+        {
+            // a escala de cinza usa apenas a coluna cinza da tabela de cores
+            cor &= 0x30;
+        }
+
+        uint16 enfase = (this->flag_enfase_r ? 1 : 0) | 
+                        (this->flag_enfase_g ? 2 : 0) | 
+                        (this->flag_enfase_b ? 4 : 0);
+        this->paleta_indices[endereco] = (enfase << 6) | cor;
+        this->paleta_rgb[endereco] = cores::tabela_rgb_enfase[this->paleta_indices[endereco]];
     }
 
     byte Ppu::buscar_pixel_fundo()
@@ -364,38 +758,14 @@ namespace nesbrasa::nucleo
         return static_cast<byte>(cor & 0x0F);
     }
 
-    byte Ppu::buscar_pixel_sprite(byte& indice)
+    byte Ppu::buscar_pixel_sprite()
     {
         if (this->flag_sprite_habilitar == 0)
         {
-            indice = 0;
             return 0;
         }
 
-        for (int i = 0; i < this->sprites_qtd; i++)
-        {
-            int offset = (this->ciclo - 1) - static_cast<int>(this->sprites_posicoes.at(i));
-            if (offset < 0 || offset > 7) 
-            {
-                continue;
-            }
-
-            offset = 7 - offset;
-            byte cor = (this->sprites_padroes.at(i) >> (offset*4)) & 0x0F;
-            if (cor%4 == 0) 
-            {
-                continue;
-            }
-
-            if (i != 0)
-                std::cout << "aaa " << (int)i << " bbb " << offset  << " cor " << cor << "\n";
-            
-            indice = i;
-            return cor;
-        }
-
-        indice = 0;
-        return 0;
+        return this->sprites_linha[this->ciclo - 1];
     }
 
     byte Ppu::buscar_cor_fundo(byte dados)
@@ -499,92 +869,59 @@ namespace nesbrasa::nucleo
             endereco = 0x1000*tabela + tile*16 + linha;
         }
 
-        byte atrib = (atributos & 3) << 2;
-        byte tile_byte_menor = this->ler(this->memoria->nes, endereco);
-        byte tile_byte_maior = this->ler(this->memoria->nes, endereco+8);
+        // a linha é buscada já decodificada e espelhada no cache da memória CHR
+        const bool espelhado = atributos&0x40 == 0x40;
+        uint32 atrib = static_cast<uint32>((atributos & 3) << 2);
+        uint32 valor = this->buscar_chr_linha(endereco, espelhado);
 
-        uint32 valor = 0;
-        for (int i = 0; i < 8; i++)
-        {
-            byte p1 = 0;
-            byte p2 = 0;
-            if (atributos&0x40 == 0x40)
-            {
-                p1 = (tile_byte_menor & 1) << 0;
-                p2 = (tile_byte_maior & 1) << 1;
-                tile_byte_menor >>= 1;
-                tile_byte_maior >>= 1;
-            }
-            else
-            {
-                p1 = (tile_byte_menor & 0x80) >> 7;
-                p2 = (tile_byte_maior & 0x80) >> 6;
-                tile_byte_menor <<= 1;
-                tile_byte_maior <<= 1;
-            }
-
-            valor <<= 4;
-            valor |= static_cast<uint32>(atrib | p1 | p2);
-        }
-
-        return valor;
+        return valor | atrib*0x11111111;
     }
 
     void Ppu::renderizar_pixel()
     {
+        // sem imagem, os pixels só são compostos para detectar a colisão do sprite 0
+        if (!this->is_imagem_produzida() && (!this->sprites_linha_zero || this->flag_sprite_zero))
+        {
+            return;
+        }
+
         int pos_x = this->ciclo - 1;
         int pos_y = this->scanline;
-        byte indice = 0;
         byte fundo = this->buscar_pixel_fundo();
-        byte sprite = this->buscar_pixel_sprite(indice);
+        byte sprite = this->buscar_pixel_sprite();
 
         if (pos_x < 8 && !this->flag_fundo_habilitar_col_esquerda)
             fundo = 0;
         if (pos_x < 8 && !this->flag_sprite_habilitar_col_esquerda)
             sprite = 0;
 
-        bool f = fundo%4 != 0;
-        bool s = sprite%4 != 0;
-        byte cor = 0;
-        if (!f && !s)
-        {
-            cor = 0;
-        }
-        else if (!f && s)
+        bool sprite_zero = false;
+        byte cor = compositor::compor_pixel(fundo, sprite, sprite_zero);
+        if (sprite_zero && pos_x < 255)
         {
-            cor = sprite | 0x10;
+            this->flag_sprite_zero = true;
         }
-        else if (f && !s)
+
+        if (this->video_frame == PpuVideo::INDICES)
         {
-            cor = fundo;
+            (*this->indices_fundo)[pos_y*256 + pos_x] = this->paleta_indices[cor];
         }
-        else
+        else if (this->video_frame == PpuVideo::COMPLETO)
         {
-            if (this->sprites_indices.at(indice) == 0 && pos_x < 255)
-            {
-                this->flag_sprite_zero = true;
-            }
-            
-            if (this->sprites_prioridades.at(indice) == 0)
-            {
-                cor = sprite | 0x10;
-            }
-            else
-            {
-                cor = fundo;
-            }
+            (*this->fundo)[pos_y*256 + pos_x] = this->paleta_rgb[cor];
         }
-        
-        auto cor_nes = this->ler_paleta(static_cast<uint16>(cor));
-        this->fundo.at(pos_y*256 + pos_x) = cores::tabela_rgb.at(cor_nes%64);
     }
 
     void Ppu::executar_ciclo_vblank()
     {
-        auto aux = this->frente;
-        this->frente = this->fundo;
-        this->fundo = aux;
+        // frames pulados não foram desenhados, então a textura da frente é mantida
+        if (!this->frame_pulado)
+        {
+            std::swap(this->frente, this->fundo);
+            std::swap(this->indices_frente, this->indices_fundo);
+        }
 
+        this->frames_completos += 1;
         this->nmi_ocorreu = true;
         this->alterar_nmi();
     }
@@ -608,16 +945,16 @@ namespace nesbrasa::nucleo
     void Ppu::buscar_byte_tabela_de_nomes()
     {
         uint16 v = this->v;
-	    uint16 endereco = 0x2000 | (v & 0x0FFF);
-	    this->tabela_de_nomes_byte = this->ler(this->memoria->nes, endereco);
+        this->tabela_de_nomes_byte = this->tabelas_de_nomes_ponteiros[(v >> 10) & 3][v & 0x3FF];
     }
 
     void Ppu::buscar_byte_tabela_de_atributos()
     {
         uint16 v = this->v;
-        uint16 endereco = 0x23C0 | (v & 0x0C00) | ((v >> 4) & 0x38) | ((v >> 2) & 0x07);
+        uint16 offset = 0x03C0 | ((v >> 4) & 0x38) | ((v >> 2) & 0x07);
         uint16 shift = ((v >> 4) & 4) | (v & 2);
-        this->tabela_de_atributos_byte = ((this->ler(this->memoria->nes, endereco) >> shift) & 3) << 2;
+        byte atributos = this->tabelas_de_nomes_ponteiros[(v >> 10) & 3][offset];
+        this->tabela_de_atributos_byte = ((atributos >> shift) & 3) << 2;
     }
 
     void Ppu::buscar_tile_byte_menor()
@@ -626,7 +963,8 @@ namespace nesbrasa::nucleo
         uint16 tabela = this->flag_padrao_fundo ? 1 : 0;
         uint16 tile = this->tabela_de_nomes_byte;
         uint16 endereco = 0x1000*tabela + tile*16 + y;
-        this->tile_byte_menor = this->ler(this->memoria->nes, endereco);
+        uint32 linha = this->buscar_chr_linha(endereco, false);
+        this->tile_linha = (this->tile_linha & 0x22222222) | (linha & 0x11111111);
     }
 
     void Ppu::buscar_tile_byte_maior()
@@ -635,26 +973,49 @@ namespace nesbrasa::nucleo
         uint16 tabela = this->flag_padrao_fundo ? 1 : 0;
         uint16 tile = this->tabela_de_nomes_byte;
         uint16 endereco = 0x1000*tabela + tile*16 + y;
-        this->tile_byte_maior = this->ler(this->memoria->nes, endereco+8);
+        uint32 linha = this->buscar_chr_linha(endereco, false);
+        this->tile_linha = (this->tile_linha & 0x11111111) | (linha & 0x22222222);
     }
 
     void Ppu::tile_guardar_dados()
     {
-        uint32 valor = 0;
-        for (int i = 0; i < 8; i++)
+        uint32 atributos = this->tabela_de_atributos_byte;
+        this->tile_dados |= static_cast<uint64>(this->tile_linha | atributos*0x11111111);
+        this->tile_linha = 0;
+    }
+
+    void Ppu::avaliar_sprites()
+    {
+        if (this->sprites_baldes_desatualizados)
         {
-            byte a = this->tabela_de_atributos_byte;
-            byte p1 = (this->tile_byte_menor & 0x80) >> 7;
-            byte p2 = (this->tile_byte_maior & 0x80) >> 6;
-            this->tile_byte_menor <<= 1;
-		    this->tile_byte_maior <<= 1;
-            valor <<= 4;
-            valor |= static_cast<uint32>(a | p1 | p2);
+            this->construir_sprites_baldes();
+        }
+
+        const auto& balde = this->sprites_baldes[this->scanline];
+        int contagem = this->sprites_baldes_qtd[this->scanline];
+        for (int j = 0; j < contagem && j < 8; j++)
+        {
+            int i = balde[j];
+            uint pos_y = this->oam[i*4+0];
+            uint atrib = this->oam[i*4+2];
+            uint pos_x = this->oam[i*4+3];
+            int linha = this->scanline - static_cast<int>(pos_y);
+
+            this->sprites_padroes[j] = this->buscar_padrao_sprite(i, linha);
+            this->sprites_posicoes[j] = pos_x;
+            this->sprites_prioridades[j] = (atrib >> 5) & 1;
+            this->sprites_indices[j] = i;
         }
-        this->tile_dados |= static_cast<uint64>(valor);
+        if (contagem > 8)
+        {
+            contagem = 8;
+            this->flag_sprite_transbordamento = true;
+        }
+        this->sprites_qtd = contagem;
+        this->rasterizar_sprites();
     }
 
-    void Ppu::avaliar_sprites()
+    void Ppu::construir_sprites_baldes()
     {
         int altura = 0;
         if (!this->flag_sprite_altura)
@@ -666,33 +1027,57 @@ namespace nesbrasa::nucleo
             altura = 16;
         }
 
-        int contagem = 0;
+        this->sprites_baldes_qtd.fill(0);
         for (int i = 0; i < 64; i++)
         {
-            uint pos_y = this->oam.at(i*4+0);
-            uint atrib = this->oam.at(i*4+2);
-            uint pos_x = this->oam.at(i*4+3);
-            int linha = this->scanline - static_cast<int>(pos_y);
-            if (linha < 0 || linha >= altura)
+            int pos_y = this->oam[i*4+0];
+            for (int scanline = pos_y; scanline < pos_y + altura && scanline < TELA_ALTURA; scanline++)
             {
-                continue;
+                // só os 8 primeiros sprites são guardados, mas a contagem continua
+                // para que o transbordamento seja detectado
+                byte& qtd = this->sprites_baldes_qtd[scanline];
+                if (qtd < 8)
+                {
+                    this->sprites_baldes[scanline][qtd] = static_cast<byte>(i);
+                }
+                qtd++;
             }
+        }
+
+        this->sprites_baldes_desatualizados = false;
+    }
 
-            if (contagem < 8)
+    void Ppu::rasterizar_sprites()
+    {
+        this->sprites_linha.fill(0);
+        this->sprites_linha_zero = false;
+
+        // percorre os sprites de trás para frente, já que o primeiro sprite
+        // com um pixel visível tem prioridade
+        for (int i = this->sprites_qtd - 1; i >= 0; i--)
+        {
+            byte atributos = 0;
+            if (this->sprites_prioridades[i] != 0)
+                atributos |= compositor::SPRITE_ATRAS;
+            if (this->sprites_indices[i] == 0)
+                atributos |= compositor::SPRITE_ZERO;
+
+            for (int offset = 0; offset < 8; offset++)
             {
-                this->sprites_padroes.at(contagem) = this->buscar_padrao_sprite(i, linha);
-                this->sprites_posicoes.at(contagem) = pos_x;
-                this->sprites_prioridades.at(contagem) = (atrib >> 5) & 1;
-                this->sprites_indices.at(contagem) = i;
+                int pos_x = static_cast<int>(this->sprites_posicoes[i]) + offset;
+                byte cor = (this->sprites_padroes[i] >> ((7 - offset)*4)) & 0x0F;
+                if (pos_x > 255 || cor%4 == 0)
+                {
+                    continue;
+                }
+
+                this->sprites_linha[pos_x] = cor | atributos;
+                if (this->sprites_indices[i] == 0)
+                {
+                    this->sprites_linha_zero = true;
+                }
             }
-            contagem++;
         }
-        if (contagem > 8)
-        {
-            contagem = 8;
-            this->flag_sprite_transbordamento = true;
-        }
-        this->sprites_qtd = contagem;
     }
 
     void Ppu::copiar_x()
@@ -755,7 +1140,12 @@ namespace nesbrasa::nucleo
         this->flag_incrementar = (valor >> 2) & 1;
         this->flag_padrao_sprite =  (valor >> 3) & 1;
         this->flag_padrao_fundo = (valor >> 4) & 1;
-        this->flag_sprite_altura = (valor >> 5) & 1;
+        bool sprite_altura = (valor >> 5) & 1;
+        if (sprite_altura != this->flag_sprite_altura)
+        {
+            this->sprites_baldes_desatualizados = true;
+        }
+        this->flag_sprite_altura = sprite_altura;
         this->flag_mestre_escravo = (valor >> 6) & 1;
         this->nmi_output = (valor>>7)&1 == 1;
         this->alterar_nmi();
@@ -776,6 +1166,8 @@ namespace nesbrasa::nucleo
         this->flag_enfase_r = (valor >> 5) & 1;
         this->flag_enfase_g = (valor >> 6) & 1;
         this->flag_enfase_b = (valor >> 7) & 1;
+
+        this->atualizar_paleta_rgb();
     }
 
     byte Ppu::get_estado()
@@ -803,6 +1195,12 @@ namespace nesbrasa::nucleo
 
     void Ppu::set_oam_dados(byte valor)
     {
+        // apenas a posição vertical altera os sprites de cada scanline
+        if (this->oam_endereco % 4 == 0)
+        {
+            this->sprites_baldes_desatualizados = true;
+        }
+
         this->oam.at(this->oam_endereco) = valor;
         this->oam_endereco += 1;
     }
@@ -868,6 +1266,7 @@ namespace nesbrasa::nucleo
             this->oam_endereco++;
             ponteiro++;
         }
+        this->sprites_baldes_desatualizados = true;
 
         nes->cpu.esperar_adicionar(513);
         if ((nes->cpu.get_ciclos() % 2) == 1)
@@ -908,16 +1307,322 @@ namespace nesbrasa::nucleo
             this->v += 32;
     }
 
-    uint16 Ppu::endereco_espelhado(byte modo, uint16 endereco)
+    void Ppu::mapear_chr_bancos(const array<const uint32*, 8>& bancos, 
+                                const array<const uint32*, 8>& espelhados)
+    {
+        // banco usado enquanto nenhum cartucho estiver mapeado
+        static const array<uint32, 0x200> banco_vazio {};
+
+        // as buscas feitas com os bancos anteriores são executadas antes
+        this->sincronizar();
+
+        for (int i = 0; i < 8; i++)
+        {
+            this->chr_bancos[i] = bancos[i] ? bancos[i] : banco_vazio.data();
+            this->chr_bancos_espelhados[i] = espelhados[i] ? espelhados[i] : banco_vazio.data();
+        }
+    }
+
+    uint32 Ppu::buscar_chr_linha(uint16 endereco, bool espelhado)
+    {
+        // cada banco de 1KiB possui 64 tiles com 8 linhas
+        const uint16 indice = ((endereco & 0x03F0) >> 1) | (endereco & 0x07);
+        const uint16 janela = (endereco >> 10) & 7;
+        return espelhado ? this->chr_bancos_espelhados[janela][indice] : this->chr_bancos[janela][indice];
+    }
+
+    void Ppu::mapear_tabelas_de_nomes(byte modo)
+    {
+        // os acessos feitos com o espelhamento anterior são executados antes
+        this->sincronizar();
+
+        for (int i = 0; i < 4; i++)
+        {
+            // a ppu só possui 2KiB, as tabelas restantes do modo de 4 telas são espelhadas
+            uint16 posicao = (espelhamento_tabela.at(modo).at(i) * 0x0400) % this->tabelas_de_nomes.size();
+            this->tabelas_de_nomes_ponteiros[i] = &this->tabelas_de_nomes[posicao];
+        }
+    }
+
+    PpuRenderizacao Ppu::get_renderizacao()
+    {
+        return this->renderizacao;
+    }
+
+    void Ppu::set_renderizacao(PpuRenderizacao renderizacao)
+    {
+        // a linha atual é terminada ponto a ponto nos dois modos
+        this->sincronizar();
+        this->sincronizar_linha();
+        this->renderizacao = renderizacao;
+        this->linha_ponto_a_ponto = true;
+    }
+
+    PpuVideo Ppu::get_video()
     {
-        uint16 endereco_espelhado = (endereco - 0x2000) % 0x1000;
-        uint16 tabela = endereco_espelhado / 0x0400;
-        uint16 offset = endereco_espelhado % 0x0400;
-        return 0x2000 + espelhamento_tabela.at(modo).at(tabela) * 0x0400 + offset;
+        return this->video;
     }
 
-    array<uint32, (256*240)>& Ppu::get_textura()
+    void Ppu::set_video(PpuVideo video)
     {
-        return this->frente;
+        this->sincronizar();
+        this->sincronizar_linha();
+        this->video = video;
+        this->atualizar_video_frame();
+
+        const bool texturas_internas = this->frente == this->texturas_internas[0].get() ||
+                                       this->frente == this->texturas_internas[1].get();
+        if (video == PpuVideo::COMPLETO && this->frente == nullptr)
+        {
+            this->set_texturas(nullptr, nullptr);
+        }
+        else if (video != PpuVideo::COMPLETO && texturas_internas)
+        {
+            // sem imagem, as texturas internas deixam de ser necessárias
+            this->texturas_internas[0].reset();
+            this->texturas_internas[1].reset();
+            this->set_texturas(nullptr, nullptr);
+        }
+
+        const bool indices_internos = this->indices_frente == this->texturas_indices_internas[0].get() ||
+                                      this->indices_frente == this->texturas_indices_internas[1].get();
+        if (video == PpuVideo::INDICES && this->indices_frente == nullptr)
+        {
+            this->set_texturas_indices(nullptr, nullptr);
+        }
+        else if (video != PpuVideo::INDICES && indices_internos)
+        {
+            this->texturas_indices_internas[0].reset();
+            this->texturas_indices_internas[1].reset();
+            this->set_texturas_indices(nullptr, nullptr);
+        }
+    }
+
+    void Ppu::pular_frames(uint32 quantidade)
+    {
+        // os pontos adiados podem já ter passado da prelinha, que decide se o frame é pulado
+        this->sincronizar();
+
+        this->frames_pular = quantidade;
+    }
+
+    bool Ppu::is_frame_pulado()
+    {
+        this->sincronizar();
+        return this->frame_pulado;
+    }
+
+    void Ppu::atualizar_video_frame()
+    {
+        // frames pulados não buscam os tiles do fundo, como no modo 'SPRITE_ZERO'
+        this->video_frame = this->video;
+        if (this->frame_pulado && (this->video == PpuVideo::COMPLETO || this->video == PpuVideo::INDICES))
+        {
+            this->video_frame = PpuVideo::SPRITE_ZERO;
+        }
+    }
+
+    bool Ppu::is_imagem_produzida()
+    {
+        return this->video_frame == PpuVideo::COMPLETO || this->video_frame == PpuVideo::INDICES;
+    }
+
+    Textura& Ppu::get_textura()
+    {
+        this->sincronizar();
+
+        if (this->frente == nullptr)
+        {
+            throw std::runtime_error("Erro: a ppu não está produzindo imagens");
+        }
+
+        return *this->frente;
+    }
+
+    void Ppu::set_texturas(Textura* frente, Textura* fundo)
+    {
+        this->sincronizar();
+
+        if (frente == nullptr || fundo == nullptr)
+        {
+            // as texturas internas só são alocadas quando a imagem é produzida
+            if (this->video == PpuVideo::COMPLETO && this->texturas_internas[0] == nullptr)
+            {
+                this->texturas_internas[0] = std::make_unique<Textura>();
+                this->texturas_internas[1] = std::make_unique<Textura>();
+            }
+
+            frente = this->texturas_internas[0].get();
+            fundo = this->texturas_internas[1].get();
+        }
+
+        this->frente = frente;
+        this->fundo = fundo;
+    }
+
+    TexturaIndices& Ppu::get_textura_indices()
+    {
+        this->sincronizar();
+
+        if (this->indices_frente == nullptr)
+        {
+            throw std::runtime_error("Erro: a ppu não está produzindo imagens de índices");
+        }
+
+        return *this->indices_frente;
+    }
+
+    void Ppu::set_texturas_indices(TexturaIndices* frente, TexturaIndices* fundo)
+    {
+        this->sincronizar();
+
+        if (frente == nullptr || fundo == nullptr)
+        {
+            // as texturas internas só são alocadas quando a imagem de índices é produzida
+            if (this->video == PpuVideo::INDICES && this->texturas_indices_internas[0] == nullptr)
+            {
+                this->texturas_indices_internas[0] = std::make_unique<TexturaIndices>();
+                this->texturas_indices_internas[1] = std::make_unique<TexturaIndices>();
+
+                // o índice 0 é o cinza $00, então as texturas começam com o preto $0F,
+                // como as texturas RGB, que começam zeradas
+                this->texturas_indices_internas[0]->fill(0x0F);
+                this->texturas_indices_internas[1]->fill(0x0F);
+            }
+
+            frente = this->texturas_indices_internas[0].get();
+            fundo = this->texturas_indices_internas[1].get();
+        }
+
+        this->indices_frente = frente;
+        this->indices_fundo = fundo;
+    }
+
+    uint64 Ppu::get_frames_completos()
+    {
+        return this->frames_completos;
+    }
+
+    uint32 Ppu::pontos_desde_vblank()
+    {
+        this->sincronizar();
+
+        const int atual = this->scanline*341 + this->ciclo;
+        const int inicio = 241*341 + 1;
+        if (this->scanline < 241 || this->scanline > 260 || atual < inicio)
+        {
+            return 0;
+        }
+
+        return atual - inicio;
+    }
+
+    uint32 Ppu::pontos_ate_vblank()
+    {
+        this->sincronizar();
+
+        return this->pontos_ate(241, 1);
+    }
+
+    uint32 Ppu::pontos_ate_nmi()
+    {
+        // os pontos adiados nunca chegam ao horizonte, então nada que gere um NMI
+        // foi pulado e a distância diminui junto com os pontos adiados
+        if (this->pontos_pendentes > 0)
+        {
+            return this->pontos_horizonte - this->pontos_pendentes;
+        }
+
+        // o NMI é gerado quando a contagem chega a 0
+        if (this->nmi_atrasar > 0)
+        {
+            return this->nmi_atrasar;
+        }
+
+        // o início do vblank é o único ponto que pode iniciar uma nova contagem
+        return this->pontos_ate_vblank();
+    }
+
+    uint32 Ppu::pontos_estado_estavel()
+    {
+        this->sincronizar();
+
+        // a leitura de PPUSTATUS limpa a flag de vblank
+        if (this->nmi_ocorreu)
+        {
+            return 0;
+        }
+
+        // o vblank começa em (241, 1) e termina em (261, 1), onde as flags dos sprites são limpas
+        uint32 pontos = std::min(this->pontos_ate(241, 1), this->pontos_ate(261, 1)) - 1;
+
+        bool renderizacao_habilitada = this->flag_fundo_habilitar || this->flag_sprite_habilitar;
+        if (!renderizacao_habilitada || (this->flag_sprite_zero && this->flag_sprite_transbordamento))
+        {
+            return pontos;
+        }
+
+        // a flag de transbordamento só é alterada na avaliação dos sprites,
+        // no ciclo 257 das linhas visíveis
+        if (this->scanline < 240 && this->ciclo < 257)
+        {
+            pontos = std::min(pontos, this->pontos_ate(this->scanline, 257) - 1);
+        }
+        else if (this->scanline < 239)
+        {
+            pontos = std::min(pontos, this->pontos_ate(this->scanline + 1, 257) - 1);
+        }
+        else if (this->scanline == 261)
+        {
+            pontos = std::min(pontos, this->pontos_ate(0, 257) - 1);
+        }
+
+        // o sprite 0 só pode ser encontrado nos pixels das linhas em que ele foi avaliado
+        if (!this->flag_sprite_zero && this->is_sprite_zero_na_linha())
+        {
+            if (this->scanline < 240 && this->ciclo < 255)
+            {
+                return 0;
+            }
+            else if (this->scanline < 239 && this->ciclo >= 257)
+            {
+                pontos = std::min(pontos, this->pontos_ate(this->scanline + 1, 1) - 1);
+            }
+        }
+
+        return pontos;
+    }
+
+    uint32 Ppu::pontos_ate(int scanline, int ciclo)
+    {
+        int atual = this->scanline*341 + this->ciclo;
+        int destino = scanline*341 + ciclo;
+
+        int distancia = destino - atual;
+        if (distancia <= 0)
+        {
+            distancia += 262*341;
+        }
+
+        // um ponto é pulado nos frames ímpares quando a renderização está habilitada
+        if ((this->flag_fundo_habilitar || this->flag_sprite_habilitar) && distancia > 1)
+        {
+            distancia -= 1;
+        }
+
+        return distancia;
+    }
+
+    bool Ppu::is_sprite_zero_na_linha()
+    {
+        for (int i = 0; i < this->sprites_qtd; i++)
+        {
+            if (this->sprites_indices.at(i) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
     }
 }
@@ -32,9 +32,46 @@ namespace nesbrasa::nucleo
 {
     using std::array;
     using std::shared_ptr;
+    using std::unique_ptr;
     
     extern array< array<uint16, 4>, 5> espelhamento_tabela;
 
+    //! Textura RGB representando a tela do NES, pode ser convertida com 'saida::converter_textura'
+    using Textura = array<uint32, (256*240)>;
+
+    /*! Tela do NES com o índice de cada pixel em 'cores::tabela_rgb_enfase': a cor
+        nos bits 0-5 e a ênfase de PPUMASK nos bits 6-8. Pode ser convertida
+        com 'saida::converter_textura_indices'
+    */
+    using TexturaIndices = array<uint16, (256*240)>;
+
+    //! Formas de executar os pontos visíveis de uma scanline
+    enum class PpuRenderizacao
+    {
+        // cada ponto é executado na chamada de 'avancar' correspondente
+        PONTO,
+        // os pontos visíveis são executados de uma vez no fim da parte visível da linha,
+        // voltando a ser executados ponto a ponto caso a cpu acesse os registradores da ppu
+        LINHA,
+    };
+
+    //! Quanto da imagem é produzida pela ppu
+    enum class PpuVideo
+    {
+        // todos os pixels são desenhados na textura
+        COMPLETO,
+        // nenhum pixel é desenhado, mas tudo que a cpu pode observar continua sendo
+        // calculado, incluindo a colisão do sprite 0 e todas as buscas de memória
+        TEMPORIZACAO,
+        // igual a 'TEMPORIZACAO', mas os tiles do fundo só são buscados nas linhas em
+        // que o sprite 0 ainda pode colidir. Só pode ser usado com mapeadores que não
+        // observam os endereços acessados pela ppu
+        SPRITE_ZERO,
+        // todos os pixels são desenhados como índices de cores em uma 'TexturaIndices',
+        // sem a conversão para RGB
+        INDICES,
+    };
+
     class Ppu
     {
     private:
@@ -43,13 +80,45 @@ namespace nesbrasa::nucleo
         int ciclo;
         int scanline;
         uint64 frame;
+        uint64 frames_completos; // quantidade de vezes que o vblank começou
+
+        PpuRenderizacao renderizacao;
+        // indica se o resto da linha atual precisa ser executado ponto a ponto
+        bool linha_ponto_a_ponto;
+        // pontos que ainda não foram executados e o valor de 'pontos_ate_nmi'
+        // quando eles começaram a ser adiados
+        uint32 pontos_pendentes;
+        uint32 pontos_horizonte;
+        PpuVideo video;
+        // modo de vídeo usado no frame atual, que é diferente de 'video' nos frames pulados
+        PpuVideo video_frame;
+        uint32 frames_pular; // quantidade de frames que ainda vão ser pulados
+        bool frame_pulado;   // indica se o frame atual está sendo pulado
 
         array<byte, 0x20>  paletas;
+        // cores RGB de cada entrada das paletas, já com a ênfase e a escala de cinza
+        // de PPUMASK, atualizadas nas escritas nas paletas e em PPUMASK
+        array<uint32, 0x20> paleta_rgb;
+        // índices de 'cores::tabela_rgb_enfase' de cada entrada das paletas
+        array<uint16, 0x20> paleta_indices;
         array<byte, 0x800> tabelas_de_nomes;
+        // as 4 tabelas de nomes lógicas ($2000, $2400, $2800 e $2C00) já resolvidas
+        // pelo espelhamento do cartucho
+        array<byte*, 4> tabelas_de_nomes_ponteiros;
+        // linhas decodificadas dos 8 bancos CHR de 1KiB mapeados pelo cartucho
+        array<const uint32*, 8> chr_bancos;
+        array<const uint32*, 8> chr_bancos_espelhados;
         array<byte, 0x100> oam;
-        // texturas RGB representando a tela do NES
-        array<uint32, (256*240)> frente;
-        array<uint32, (256*240)> fundo;
+        // texturas alocadas pela ppu, usadas quando o usuário não fornece as suas
+        unique_ptr<Textura> texturas_internas[2];
+        // a textura da frente guarda o último frame completo e a de fundo o frame
+        // sendo desenhado, as duas são trocadas no início de cada vblank
+        Textura* frente;
+        Textura* fundo;
+        // as mesmas texturas no modo de vídeo 'INDICES'
+        unique_ptr<TexturaIndices> texturas_indices_internas[2];
+        TexturaIndices* indices_frente;
+        TexturaIndices* indices_fundo;
 
         // registradores internos
         uint16 v;
@@ -69,8 +138,9 @@ namespace nesbrasa::nucleo
         // membros relacionados às texturas de fundo
         byte tabela_de_nomes_byte;
         byte tabela_de_atributos_byte;
-        byte tile_byte_maior;
-        byte tile_byte_menor;
+        // pixels já decodificados dos 2 bytes buscados do tile, cada byte preenche
+        // um dos bits de cada pixel (0x11111111 para o menor e 0x22222222 para o maior)
+        uint32 tile_linha;
         uint64 tile_dados;
 
         int sprites_qtd;
@@ -78,6 +148,16 @@ namespace nesbrasa::nucleo
         array<byte, 8>   sprites_posicoes;
         array<byte, 8>   sprites_prioridades;
         array<int, 8>   sprites_indices;        
+        // pixels dos sprites da linha, com a cor e os bits 'SPRITE_*' do compositor
+        array<byte, 256> sprites_linha;
+        // indica se algum pixel de 'sprites_linha' pertence ao sprite 0
+        bool sprites_linha_zero;
+        // índices na OAM dos 8 primeiros sprites de cada scanline visível e a
+        // quantidade total de sprites nela, reconstruídos quando a OAM ou a
+        // altura dos sprites muda
+        array<array<byte, 8>, 240> sprites_baldes;
+        array<byte, 240> sprites_baldes_qtd;
+        bool sprites_baldes_desatualizados;
         
         uint16 vram_incrementar;
         
@@ -117,6 +197,50 @@ namespace nesbrasa::nucleo
         void atualizar();
         void avancar();
 
+        /*! Adia a execução de pontos da ppu, que são executados de uma vez quando a cpu
+            acessa os registradores da ppu, quando um NMI pode ser gerado ou no início do vblank.
+            Os métodos que expõem o estado da ppu executam os pontos adiados antes.
+            É chamado depois de cada instrução da cpu, então fica no cabeçalho
+        */
+        inline void adiar_pontos(uint32 pontos)
+        {
+            // o horizonte é calculado com a ppu sincronizada, depois dos acessos da cpu
+            if (this->pontos_pendentes == 0)
+            {
+                this->pontos_horizonte = this->pontos_ate_nmi();
+            }
+
+            this->pontos_pendentes += pontos;
+            if (this->pontos_pendentes >= this->pontos_horizonte)
+            {
+                this->sincronizar();
+            }
+        }
+
+        //! Executa os pontos adiados por 'adiar_pontos'
+        void sincronizar();
+
+        /*! Equivalente a chamar 'avancar' várias vezes, mas os pontos em que a ppu apenas
+            avança os contadores, como os do vblank ou os de quando a renderização
+            está desabilitada, são pulados de uma vez até o próximo evento
+        */
+        void avancar_pontos(uint32 pontos);
+
+        /*! Resolve as 4 tabelas de nomes lógicas para o modo de espelhamento,
+            deve ser chamado sempre que o cartucho alterar o espelhamento
+            \param modo Índice da linha de 'espelhamento_tabela'
+        */
+        void mapear_tabelas_de_nomes(byte modo);
+
+        /*! Passa a buscar os padrões dos tiles nos bancos CHR fornecidos, deve ser
+            chamado sempre que o cartucho trocar os bancos CHR
+            \param bancos Linhas decodificadas de cada banco de 1KiB, os bancos
+                          nulos são tratados como bancos vazios
+            \param espelhados As mesmas linhas espelhadas horizontalmente
+        */
+        void mapear_chr_bancos(const array<const uint32*, 8>& bancos, 
+                               const array<const uint32*, 8>& espelhados);
+
         byte ler(Nes *nes, uint16 endereco);
         void escrever(Nes *nes, uint16 endereco, byte valor);
 
@@ -126,16 +250,112 @@ namespace nesbrasa::nucleo
         byte ler_paleta(uint16 endereco);
         void escrever_paleta(uint16 endereco, byte valor);
 
-        array<uint32, (256*240)>& get_textura();
+        PpuRenderizacao get_renderizacao();
+        void set_renderizacao(PpuRenderizacao renderizacao);
+
+        PpuVideo get_video();
+
+        /*! Altera quanto da imagem é produzida. As texturas internas de cada tipo
+            só ficam alocadas no modo que as usa, 'COMPLETO' ou 'INDICES'
+        */
+        void set_video(PpuVideo video);
+
+        /*! Executa os próximos frames sem desenhar a imagem, mantendo tudo que a cpu
+            pode observar, como a colisão do sprite 0 e o transbordamento de sprites.
+            As texturas não são trocadas no vblank dos frames pulados, então 'get_textura'
+            continua devolvendo o último frame desenhado
+            \param quantidade Quantidade de frames a serem pulados a partir da próxima
+                              prelinha, substituindo os que ainda não foram pulados
+        */
+        void pular_frames(uint32 quantidade);
+
+        //! Checa se o frame atual está sendo executado sem desenhar a imagem
+        bool is_frame_pulado();
+
+        /*! Textura com o último frame completo, válida até o início do próximo vblank
+            Lança uma exceção caso nenhuma textura esteja sendo usada pela ppu
+        */
+        Textura& get_textura();
+
+        /*! Passa a desenhar os frames nas texturas fornecidas, que são trocadas
+            sem cópias a cada vblank. As texturas precisam continuar existindo
+            enquanto forem usadas pela ppu
+            \param frente Textura devolvida por 'get_textura' até o próximo vblank
+            \param fundo Textura em que o próximo frame vai ser desenhado
+            Caso alguma das texturas seja nullptr, as texturas internas voltam a ser usadas,
+            sendo alocadas apenas no modo de vídeo 'COMPLETO'
+        */
+        void set_texturas(Textura* frente, Textura* fundo);
+
+        /*! Textura de índices com o último frame completo no modo de vídeo 'INDICES',
+            válida até o início do próximo vblank
+            Lança uma exceção caso nenhuma textura de índices esteja sendo usada pela ppu
+        */
+        TexturaIndices& get_textura_indices();
+
+        /*! Igual a 'set_texturas', para as texturas de índices do modo de vídeo 'INDICES'.
+            As texturas internas só são alocadas no modo 'INDICES' e começam preenchidas
+            com o preto $0F
+        */
+        void set_texturas_indices(TexturaIndices* frente, TexturaIndices* fundo);
+
+        //! Quantidade de frames completos, contados no início de cada vblank
+        uint64 get_frames_completos();
+
+        /*! Quantidade de chamadas a 'avancar' feitas depois do início do vblank atual
+            \return 0 caso a ppu não esteja no vblank
+        */
+        uint32 pontos_desde_vblank();
+
+        //! Quantidade de chamadas a 'avancar' até o início do próximo vblank
+        uint32 pontos_ate_vblank();
+
+        /*! Quantidade de chamadas a 'avancar' até a próxima chamada que pode gerar
+            um NMI, sem contar as escritas feitas pela cpu. O valor é conservador e 
+            já desconta os pontos adiados */
+        uint32 pontos_ate_nmi();
+
+        /*! Quantidade de chamadas a 'avancar' que podem ser feitas sem que o valor
+            lido em PPUSTATUS ($2002) seja alterado. O valor retornado é conservador
+            e pode ser menor do que a quantidade real
+        */
+        uint32 pontos_estado_estavel();
 
     private:
         byte buscar_pixel_fundo();
-        byte buscar_pixel_sprite(byte& indice);
+        byte buscar_pixel_sprite();
         byte buscar_cor_fundo(byte dados);
         byte buscar_cor_pixel(byte dados);
         uint32 buscar_padrao_sprite(int i, int linha);
+        //! Busca uma linha de 8 pixels já decodificada de um tile nos bancos CHR
+        uint32 buscar_chr_linha(uint16 endereco, bool espelhado);
         void renderizar_pixel();
 
+        /*! Executa a parte da renderização de um ponto: pixels, buscas de tiles e scroll
+            \param acoes Ações do ponto, buscadas na tabela de ações de cada ponto
+        */
+        void renderizar_ponto(uint16 acoes);
+        //! Executa de uma vez os pontos visíveis da linha atual que foram adiados
+        void renderizar_linha();
+        //! Checa se o ponto atual está sendo adiado pela renderização por linha
+        bool is_ponto_adiado();
+        //! Executa os pontos adiados da linha antes da cpu acessar a ppu
+        void sincronizar_linha();
+        //! Procura a colisão do sprite 0 em uma linha sem desenhar os pixels
+        void detectar_sprite_zero(const byte* fundo_linha, const byte* sprites);
+        //! Checa se os tiles do fundo precisam ser buscados no modo de vídeo atual
+        bool is_fundo_necessario();
+        //! Checa se os pixels do frame atual são desenhados em alguma textura
+        bool is_imagem_produzida();
+        //! Escolhe o modo de vídeo do frame atual a partir de 'video' e 'frame_pulado'
+        void atualizar_video_frame();
+        //! Atualiza as cores de 'paleta_rgb', deve ser chamado quando a ênfase ou a escala de cinza mudar
+        void atualizar_paleta_rgb();
+        //! Atualiza a cor de uma entrada de 'paleta_rgb'
+        void atualizar_paleta_rgb(uint16 endereco);
+        //! Quantidade de pontos seguintes ao atual que não executam nenhuma ação
+        uint32 pontos_ociosos();
+
         void executar_ciclo_vblank();
         void encerrar_ciclo_vblank();
         void alterar_nmi();
@@ -146,6 +366,10 @@ namespace nesbrasa::nucleo
         void buscar_tile_byte_maior();
         void tile_guardar_dados();
         void avaliar_sprites();
+        //! Desenha os sprites encontrados por 'avaliar_sprites' em 'sprites_linha'
+        void rasterizar_sprites();
+        //! Reconstrói os sprites de cada scanline a partir da OAM
+        void construir_sprites_baldes();
 
         void copiar_x();
         void copiar_y();
@@ -164,7 +388,9 @@ namespace nesbrasa::nucleo
         byte get_dados();
         void set_dados(Nes *nes, byte valor);
 
-        uint16 endereco_espelhado(byte modo, uint16 endereco);
+        //! Quantidade de chamadas a 'avancar' até o ponto (scanline, ciclo) ser executado
+        uint32 pontos_ate(int scanline, int ciclo);
+        bool is_sprite_zero_na_linha();
 
         void set_textura_valor(array<byte, (256*240)>& textura, int x, int y, int valor);
     };
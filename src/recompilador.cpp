@@ -0,0 +1,413 @@
+/* recompilador.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "recompilador.hpp"
+#include "cpu.hpp"
+#include "instrucao.hpp"
+
+#if defined(__x86_64__) && defined(__unix__)
+#define NESBRASA_RECOMPILADOR_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace nesbrasa::nucleo
+{
+    const size_t Recompilador::MEMORIA_TAMANHO = 4 * 1024 * 1024;
+    const uint32 Recompilador::LIMIAR_EXECUCOES = 16;
+
+    //! Calcula a distância entre um membro da cpu e o início do objeto
+    template<typename T>
+    static int32 deslocamento(Cpu* cpu, T* membro)
+    {
+        return static_cast<int32>(reinterpret_cast<byte*>(membro) - reinterpret_cast<byte*>(cpu));
+    }
+
+    static void emitir_bytes(vector<byte>& codigo, std::initializer_list<byte> bytes)
+    {
+        codigo.insert(codigo.end(), bytes);
+    }
+
+    template<typename T>
+    static void emitir_valor(vector<byte>& codigo, T valor)
+    {
+        byte bytes[sizeof(T)];
+        std::memcpy(bytes, &valor, sizeof(T));
+        codigo.insert(codigo.end(), bytes, bytes + sizeof(T));
+    }
+
+    // mov byte [rbx+deslocamento], valor
+    static void emitir_mov_memoria_imediato(vector<byte>& codigo, int32 deslocamento, byte valor)
+    {
+        emitir_bytes(codigo, { 0xC6, 0x83 });
+        emitir_valor(codigo, deslocamento);
+        emitir_valor(codigo, valor);
+    }
+
+    // movzx eax, byte [rbx+deslocamento]
+    static void emitir_ler_al(vector<byte>& codigo, int32 deslocamento)
+    {
+        emitir_bytes(codigo, { 0x0F, 0xB6, 0x83 });
+        emitir_valor(codigo, deslocamento);
+    }
+
+    // mov byte [rbx+deslocamento], al
+    static void emitir_escrever_al(vector<byte>& codigo, int32 deslocamento)
+    {
+        emitir_bytes(codigo, { 0x88, 0x83 });
+        emitir_valor(codigo, deslocamento);
+    }
+
+    Recompilador::Recompilador(Cpu* cpu):
+        cpu(cpu)
+    {
+        this->memoria_executavel = nullptr;
+        this->memoria_usada = 0;
+
+        this->deslocamento_pc = deslocamento(cpu, &cpu->pc);
+        this->deslocamento_a = deslocamento(cpu, &cpu->a);
+        this->deslocamento_x = deslocamento(cpu, &cpu->x);
+        this->deslocamento_y = deslocamento(cpu, &cpu->y);
+        this->deslocamento_sp = deslocamento(cpu, &cpu->sp);
+        this->deslocamento_c = deslocamento(cpu, &cpu->c);
+        this->deslocamento_i = deslocamento(cpu, &cpu->i);
+        this->deslocamento_d = deslocamento(cpu, &cpu->d);
+        this->deslocamento_v = deslocamento(cpu, &cpu->v);
+        this->deslocamento_n = deslocamento(cpu, &cpu->n_valor);
+        this->deslocamento_z = deslocamento(cpu, &cpu->z_valor);
+        this->deslocamento_pag_alterada = deslocamento(cpu, &cpu->is_pag_alterada);
+    }
+
+    Recompilador::~Recompilador()
+    {
+#ifdef NESBRASA_RECOMPILADOR_X86_64
+        if (this->memoria_executavel != nullptr)
+        {
+            munmap(this->memoria_executavel, Recompilador::MEMORIA_TAMANHO);
+        }
+#endif
+    }
+
+    bool Recompilador::is_disponivel()
+    {
+#ifdef NESBRASA_RECOMPILADOR_X86_64
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void Recompilador::limpar()
+    {
+        this->memoria_usada = 0;
+    }
+
+    void Recompilador::traduzir(const Bloco& bloco)
+    {
+        bloco.is_traduzido = true;
+        bloco.nativo = nullptr;
+        bloco.nativo_instrucoes = 0;
+        bloco.nativo_ciclos_maximo = 0;
+
+#ifdef NESBRASA_RECOMPILADOR_X86_64
+        vector<byte> codigo;
+
+        // push rbx; push r12; sub rsp, 8 (mantém a stack alinhada em 16 bytes)
+        emitir_bytes(codigo, { 0x53, 0x41, 0x54, 0x48, 0x83, 0xEC, 0x08 });
+        // mov rbx, rdi (rbx guarda o ponteiro da cpu)
+        emitir_bytes(codigo, { 0x48, 0x89, 0xFB });
+        // xor r12d, r12d (r12d soma os ciclos das instruções chamadas)
+        emitir_bytes(codigo, { 0x45, 0x31, 0xE4 });
+
+        // ciclos das instruções geradas diretamente, conhecidos durante a tradução
+        uint32 ciclos_fixos = 0;
+        uint32 ciclos_maximo = 0;
+        size_t quantidade = 0;
+        bool ultima_nativa = false;
+
+        for (const auto& bloco_instrucao : bloco.instrucoes)
+        {
+            if (!Recompilador::is_traduzivel(bloco_instrucao))
+            {
+                break;
+            }
+
+            const Instrucao& instrucao = tabela_instrucoes[bloco_instrucao.opcode];
+            
+            ultima_nativa = this->emitir_instrucao(codigo, bloco_instrucao);
+            if (ultima_nativa)
+            {
+                ciclos_fixos += instrucao.ciclos;
+            }
+            else
+            {
+                this->emitir_chamada(codigo, bloco_instrucao);
+            }
+
+            ciclos_maximo += Recompilador::ciclos_maximo(bloco_instrucao);
+            quantidade++;
+        }
+
+        if (quantidade == 0)
+        {
+            return;
+        }
+
+        if (ultima_nativa)
+        {
+            // as instruções chamadas atualizam o pc sozinhas, as nativas só no final
+            const BlocoInstrucao& ultima = bloco.instrucoes.at(quantidade - 1);
+            const uint16 pc = ultima.pc + tabela_instrucoes[ultima.opcode].bytes;
+
+            // mov word [rbx+pc], pc
+            emitir_bytes(codigo, { 0x66, 0xC7, 0x83 });
+            emitir_valor(codigo, this->deslocamento_pc);
+            emitir_valor(codigo, pc);
+
+            emitir_mov_memoria_imediato(codigo, this->deslocamento_pag_alterada, 0);
+        }
+
+        // add r12d, ciclos_fixos
+        emitir_bytes(codigo, { 0x41, 0x81, 0xC4 });
+        emitir_valor(codigo, ciclos_fixos);
+        // mov eax, r12d
+        emitir_bytes(codigo, { 0x44, 0x89, 0xE0 });
+        // add rsp, 8; pop r12; pop rbx; ret
+        emitir_bytes(codigo, { 0x48, 0x83, 0xC4, 0x08, 0x41, 0x5C, 0x5B, 0xC3 });
+
+        if (this->memoria_executavel == nullptr)
+        {
+            void* memoria = mmap(nullptr, Recompilador::MEMORIA_TAMANHO, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memoria == MAP_FAILED)
+            {
+                return;
+            }
+            this->memoria_executavel = static_cast<byte*>(memoria);
+        }
+
+        // um bloco maior que a memória inteira continua sendo interpretado
+        if (codigo.size() > Recompilador::MEMORIA_TAMANHO)
+        {
+            return;
+        }
+
+        if (this->memoria_usada + codigo.size() > Recompilador::MEMORIA_TAMANHO)
+        {
+            // quando a memória enche, todo o código gerado é descartado e os blocos
+            // mais executados a partir daqui voltam a ser traduzidos
+            this->cpu->blocos.descartar_nativo();
+            this->limpar();
+            bloco.is_traduzido = true;
+        }
+
+        // só as páginas que recebem o código ficam graváveis durante a cópia,
+        // o resto da memória continua executável
+        static const size_t PAGINA_TAMANHO = sysconf(_SC_PAGESIZE);
+        byte* destino = this->memoria_executavel + this->memoria_usada;
+        byte* paginas_inicio = this->memoria_executavel + (this->memoria_usada / PAGINA_TAMANHO) * PAGINA_TAMANHO;
+        const size_t paginas_tamanho = destino + codigo.size() - paginas_inicio;
+
+        if (mprotect(paginas_inicio, paginas_tamanho, PROT_READ | PROT_WRITE) != 0)
+        {
+            return;
+        }
+
+        std::memcpy(destino, codigo.data(), codigo.size());
+        this->memoria_usada += codigo.size();
+
+        if (mprotect(paginas_inicio, paginas_tamanho, PROT_READ | PROT_EXEC) != 0)
+        {
+            return;
+        }
+
+        bloco.nativo = reinterpret_cast<BlocoNativo>(destino);
+        bloco.nativo_instrucoes = quantidade;
+        bloco.nativo_ciclos_maximo = ciclos_maximo;
+#endif
+    }
+
+    bool Recompilador::is_traduzivel(const BlocoInstrucao& bloco_instrucao)
+    {
+        const Instrucao& instrucao = tabela_instrucoes[bloco_instrucao.opcode];
+        const uint16 endereco = bloco_instrucao.operando;
+
+        // instruções que escrevem na memória, as outras apenas leem
+        const bool escrita = 
+            instrucao.nome == "STA"  || instrucao.nome == "STX"  || instrucao.nome == "STY"  ||
+            instrucao.nome == "ASL"  || instrucao.nome == "LSR"  || instrucao.nome == "ROL"  ||
+            instrucao.nome == "ROR"  || instrucao.nome == "INC"  || instrucao.nome == "DEC"  ||
+            instrucao.nome == "*SAX" || instrucao.nome == "*DCP" || instrucao.nome == "*ISB" ||
+            instrucao.nome == "*SLO" || instrucao.nome == "*RLA" || instrucao.nome == "*SRE" ||
+            instrucao.nome == "*RRA";
+
+        // os endereços lidos da ROM PRG não possuem efeitos colaterais
+        auto is_seguro = [escrita](uint32 inicio, uint32 fim) -> bool
+        {
+            return fim <= 0x1FFF || (!escrita && inicio >= 0x8000);
+        };
+
+        switch (instrucao.modo)
+        {
+            // só acessam a stack e os vetores de interrupção
+            case InstrucaoModo::ACM:
+            case InstrucaoModo::IMPL:
+            case InstrucaoModo::IMED:
+            case InstrucaoModo::REL:
+                return true;
+
+            // sempre acessam a página 0 da RAM
+            case InstrucaoModo::P_ZERO:
+            case InstrucaoModo::P_ZERO_X:
+            case InstrucaoModo::P_ZERO_Y:
+                return true;
+
+            case InstrucaoModo::ABS:
+                if (instrucao.nome == "JMP" || instrucao.nome == "JSR")
+                {
+                    return true;
+                }
+                return is_seguro(endereco, endereco);
+
+            // o endereço pode estar até 255 bytes depois do operando
+            case InstrucaoModo::ABS_X:
+            case InstrucaoModo::ABS_Y:
+                return is_seguro(endereco, endereco + 0xFF);
+
+            // lê o endereço de destino do JMP indireto
+            case InstrucaoModo::IND:
+                return is_seguro(endereco, endereco + 1);
+
+            // o endereço só é conhecido durante a execução
+            default:
+                return false;
+        }
+    }
+
+    uint32 Recompilador::ciclos_maximo(const BlocoInstrucao& bloco_instrucao)
+    {
+        const Instrucao& instrucao = tabela_instrucoes[bloco_instrucao.opcode];
+
+        uint32 ciclos = instrucao.ciclos + instrucao.ciclos_pag_alt;
+        if (instrucao.modo == InstrucaoModo::REL)
+        {
+            // ciclos somados pelo branch
+            ciclos += 2;
+        }
+
+        return ciclos;
+    }
+
+    bool Recompilador::emitir_instrucao(vector<byte>& codigo, const BlocoInstrucao& bloco_instrucao)
+    {
+        // atualiza as flags 'n' e 'z' com o valor de al
+        auto emitir_nz = [this, &codigo]()
+        {
+            emitir_escrever_al(codigo, this->deslocamento_n);
+            emitir_escrever_al(codigo, this->deslocamento_z);
+        };
+
+        // copia um registrador para outro, atualizando as flags caso seja necessário
+        auto emitir_transferir = [&](int32 origem, int32 destino, bool flags)
+        {
+            emitir_ler_al(codigo, origem);
+            emitir_escrever_al(codigo, destino);
+            if (flags)
+            {
+                emitir_nz();
+            }
+        };
+
+        // soma 1 ou subtrai 1 de um registrador
+        auto emitir_incrementar = [&](int32 registrador, bool incrementar)
+        {
+            emitir_ler_al(codigo, registrador);
+            if (incrementar)
+                emitir_bytes(codigo, { 0xFE, 0xC0 }); // inc al
+            else
+                emitir_bytes(codigo, { 0xFE, 0xC8 }); // dec al
+            emitir_escrever_al(codigo, registrador);
+            emitir_nz();
+        };
+
+        // carrega um valor imediato em um registrador
+        auto emitir_carregar = [&](int32 registrador, byte valor)
+        {
+            emitir_mov_memoria_imediato(codigo, registrador, valor);
+            emitir_mov_memoria_imediato(codigo, this->deslocamento_n, valor);
+            emitir_mov_memoria_imediato(codigo, this->deslocamento_z, valor);
+        };
+
+        const byte valor = static_cast<byte>(bloco_instrucao.operando);
+
+        switch (bloco_instrucao.opcode)
+        {
+            case 0xA9: emitir_carregar(this->deslocamento_a, valor); return true; // LDA #
+            case 0xA2: emitir_carregar(this->deslocamento_x, valor); return true; // LDX #
+            case 0xA0: emitir_carregar(this->deslocamento_y, valor); return true; // LDY #
+
+            case 0xAA: emitir_transferir(this->deslocamento_a, this->deslocamento_x, true); return true;   // TAX
+            case 0xA8: emitir_transferir(this->deslocamento_a, this->deslocamento_y, true); return true;   // TAY
+            case 0x8A: emitir_transferir(this->deslocamento_x, this->deslocamento_a, true); return true;   // TXA
+            case 0x98: emitir_transferir(this->deslocamento_y, this->deslocamento_a, true); return true;   // TYA
+            case 0xBA: emitir_transferir(this->deslocamento_sp, this->deslocamento_x, true); return true;  // TSX
+            case 0x9A: emitir_transferir(this->deslocamento_x, this->deslocamento_sp, false); return true; // TXS
+
+            case 0xE8: emitir_incrementar(this->deslocamento_x, true); return true;  // INX
+            case 0xC8: emitir_incrementar(this->deslocamento_y, true); return true;  // INY
+            case 0xCA: emitir_incrementar(this->deslocamento_x, false); return true; // DEX
+            case 0x88: emitir_incrementar(this->deslocamento_y, false); return true; // DEY
+
+            case 0x18: emitir_mov_memoria_imediato(codigo, this->deslocamento_c, 0); return true; // CLC
+            case 0x38: emitir_mov_memoria_imediato(codigo, this->deslocamento_c, 1); return true; // SEC
+            case 0x58: emitir_mov_memoria_imediato(codigo, this->deslocamento_i, 0); return true; // CLI
+            case 0x78: emitir_mov_memoria_imediato(codigo, this->deslocamento_i, 1); return true; // SEI
+            case 0xD8: emitir_mov_memoria_imediato(codigo, this->deslocamento_d, 0); return true; // CLD
+            case 0xF8: emitir_mov_memoria_imediato(codigo, this->deslocamento_d, 1); return true; // SED
+            case 0xB8: emitir_mov_memoria_imediato(codigo, this->deslocamento_v, 0); return true; // CLV
+
+            case 0xEA: return true; // NOP
+
+            default:
+                return false;
+        }
+    }
+
+    void Recompilador::emitir_chamada(vector<byte>& codigo, const BlocoInstrucao& bloco_instrucao)
+    {
+        // a instrução chamada calcula o endereço a partir do pc
+        // mov word [rbx+pc], pc
+        emitir_bytes(codigo, { 0x66, 0xC7, 0x83 });
+        emitir_valor(codigo, this->deslocamento_pc);
+        emitir_valor(codigo, bloco_instrucao.pc);
+
+        // mov rdi, rbx
+        emitir_bytes(codigo, { 0x48, 0x89, 0xDF });
+        // mov esi, operando
+        emitir_bytes(codigo, { 0xBE });
+        emitir_valor(codigo, static_cast<uint32>(bloco_instrucao.operando));
+        // mov rax, implementacao; call rax
+        emitir_bytes(codigo, { 0x48, 0xB8 });
+        emitir_valor(codigo, reinterpret_cast<uint64>(bloco_instrucao.implementacao));
+        emitir_bytes(codigo, { 0xFF, 0xD0 });
+        // add r12d, eax
+        emitir_bytes(codigo, { 0x41, 0x01, 0xC4 });
+    }
+}
\ No newline at end of file
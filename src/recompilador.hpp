@@ -0,0 +1,102 @@
+/* recompilador.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "blocos.hpp"
+#include "tipos_numeros.hpp"
+
+// referencias utilizadas:
+// https://www.felixcloutier.com/x86/
+// https://gitlab.com/x86-psABIs/x86-64-ABI
+
+namespace nesbrasa::nucleo
+{
+    using std::vector;
+    using namespace nesbrasa::tipos;
+
+    class Cpu;
+
+    /*! Recompilador dinâmico que traduz os blocos da ROM PRG para código x86-64.
+        As instruções mais simples são geradas diretamente em código nativo e as 
+        outras chamam as instruções especializadas, com o operando já decodificado.
+        Só é traduzido o maior prefixo do bloco que não pode acessar registradores
+        mapeados na memória (MMIO), já que o código nativo não avança a ppu
+        entre as instruções */
+    class Recompilador
+    {
+    private:
+        Cpu* cpu;
+
+        // região de memória executável onde o código gerado é guardado
+        byte* memoria_executavel;
+        size_t memoria_usada;
+
+        // deslocamento dos membros da cpu usados pelo código gerado
+        int32 deslocamento_pc;
+        int32 deslocamento_a;
+        int32 deslocamento_x;
+        int32 deslocamento_y;
+        int32 deslocamento_sp;
+        int32 deslocamento_c;
+        int32 deslocamento_i;
+        int32 deslocamento_d;
+        int32 deslocamento_v;
+        int32 deslocamento_n;
+        int32 deslocamento_z;
+        int32 deslocamento_pag_alterada;
+
+    public:
+        // tamanho da região de memória executável
+        static const size_t MEMORIA_TAMANHO;
+
+        // quantidade de vezes que um bloco precisa ser executado antes de ser traduzido
+        static const uint32 LIMIAR_EXECUCOES;
+
+        Recompilador(Cpu* cpu);
+        ~Recompilador();
+
+        Recompilador(const Recompilador&) = delete;
+        Recompilador& operator=(const Recompilador&) = delete;
+
+        //! Checa se o recompilador é suportado na plataforma atual
+        static bool is_disponivel();
+
+        /*! Traduz o bloco para código nativo, preenchendo os campos 'nativo*' do bloco. 
+            Caso nenhuma instrução possa ser traduzida, 'nativo' fica nulo */
+        void traduzir(const Bloco& bloco);
+
+        //! Descarta todo o código gerado, deve ser chamado junto com a limpeza do cache de blocos
+        void limpar();
+
+        //! Checa se uma instrução pode ser executada sem avançar a ppu
+        static bool is_traduzivel(const BlocoInstrucao& bloco_instrucao);
+
+        //! Quantidade máxima de ciclos que uma instrução pode levar, contando páginas alteradas e branches
+        static uint32 ciclos_maximo(const BlocoInstrucao& bloco_instrucao);
+
+    private:
+
+        //! Gera o código nativo de uma instrução simples, retorna false caso ela não seja suportada
+        bool emitir_instrucao(vector<byte>& codigo, const BlocoInstrucao& bloco_instrucao);
+        void emitir_chamada(vector<byte>& codigo, const BlocoInstrucao& bloco_instrucao);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,839 @@
+/* saida.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+#include "saida.hpp"
+#include "cores.hpp"
+
+#if defined(NESBRASA_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace nesbrasa::nucleo::saida
+{
+    using std::array;
+    using std::vector;
+    using std::runtime_error;
+    using namespace std::string_literals;
+
+    static const int TELA_LARGURA = 256;
+    static const int TELA_ALTURA = 240;
+
+    // conjunto de instruções usado pelas próximas conversões
+    static Simd simd_atual = get_simd_disponivel();
+
+#if defined(NESBRASA_SIMD_X86)
+    // operações usadas pelas conversões de pixels RGB, com 4 pixels por vez no SSE2 e 8 no AVX2.
+    // Cada versão é compilada só com as instruções do seu conjunto
+
+    __attribute__((target("sse2")))
+    static inline void vetor_guardar(uint32* destino, __m128i valor)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destino), valor);
+    }
+
+    __attribute__((target("sse2")))
+    static inline void vetor_guardar_16(uint16* destino, __m128i valor)
+    {
+        // o SSE2 só junta valores com sinal, então os valores são deslocados para a faixa de int16
+        valor = _mm_sub_epi32(valor, _mm_set1_epi32(0x8000));
+        valor = _mm_packs_epi32(valor, valor);
+        valor = _mm_add_epi16(valor, _mm_set1_epi16(static_cast<short>(0x8000)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(destino), valor);
+    }
+
+    __attribute__((target("sse2")))
+    static inline __m128i vetor_e(__m128i valor, uint32 mascara)
+    {
+        return _mm_and_si128(valor, _mm_set1_epi32(mascara));
+    }
+
+    __attribute__((target("sse2")))
+    static inline __m128i vetor_ou(__m128i a, __m128i b)
+    {
+        return _mm_or_si128(a, b);
+    }
+
+    __attribute__((target("sse2")))
+    static inline __m128i vetor_ou(__m128i a, uint32 b)
+    {
+        return _mm_or_si128(a, _mm_set1_epi32(b));
+    }
+
+    __attribute__((target("sse2")))
+    static inline __m128i vetor_direita(__m128i valor, int bits)
+    {
+        return _mm_srli_epi32(valor, bits);
+    }
+
+    __attribute__((target("sse2")))
+    static inline __m128i vetor_esquerda(__m128i valor, int bits)
+    {
+        return _mm_slli_epi32(valor, bits);
+    }
+
+    __attribute__((target("avx2")))
+    static inline void vetor_guardar(uint32* destino, __m256i valor)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino), valor);
+    }
+
+    __attribute__((target("avx2")))
+    static inline void vetor_guardar_16(uint16* destino, __m256i valor)
+    {
+        // 'packus' junta as metades de 128 bits intercaladas, que são reordenadas
+        valor = _mm256_packus_epi32(valor, valor);
+        valor = _mm256_permute4x64_epi64(valor, 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destino), _mm256_castsi256_si128(valor));
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i vetor_e(__m256i valor, uint32 mascara)
+    {
+        return _mm256_and_si256(valor, _mm256_set1_epi32(mascara));
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i vetor_ou(__m256i a, __m256i b)
+    {
+        return _mm256_or_si256(a, b);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i vetor_ou(__m256i a, uint32 b)
+    {
+        return _mm256_or_si256(a, _mm256_set1_epi32(b));
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i vetor_direita(__m256i valor, int bits)
+    {
+        return _mm256_srli_epi32(valor, bits);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256i vetor_esquerda(__m256i valor, int bits)
+    {
+        return _mm256_slli_epi32(valor, bits);
+    }
+#endif
+
+    /*! Cria a tabela com as 512 cores de 'cores::tabela_rgb_enfase' no formato.
+        Os pixels de 2 bytes ocupam os 16 bits menores de cada valor
+    */
+    static array<uint32, 0x200> criar_tabela(SaidaFormato formato)
+    {
+        array<uint32, 0x200> tabela {};
+        for (size_t i = 0; i < tabela.size(); i++)
+        {
+            const uint32 rgb = cores::tabela_rgb_enfase[i];
+            const byte r = (rgb >> 16) & 0xFF;
+            const byte g = (rgb >> 8) & 0xFF;
+            const byte b = rgb & 0xFF;
+
+            if (formato == SaidaFormato::RGB565)
+            {
+                tabela[i] = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+                continue;
+            }
+
+            // a ordem dos bytes na memória não depende da arquitetura
+            const byte bytes_rgba[4] = { r, g, b, 0xFF };
+            const byte bytes_bgra[4] = { b, g, r, 0xFF };
+            std::memcpy(&tabela[i], formato == SaidaFormato::RGBA8888 ? bytes_rgba : bytes_bgra, 4);
+        }
+
+        return tabela;
+    }
+
+    static const array<uint32, 0x200>& buscar_tabela(SaidaFormato formato)
+    {
+        static const array<uint32, 0x200> rgba = criar_tabela(SaidaFormato::RGBA8888);
+        static const array<uint32, 0x200> bgra = criar_tabela(SaidaFormato::BGRA8888);
+        static const array<uint32, 0x200> rgb565 = criar_tabela(SaidaFormato::RGB565);
+
+        switch (formato)
+        {
+            case SaidaFormato::BGRA8888: return bgra;
+            case SaidaFormato::RGB565: return rgb565;
+            default: return rgba;
+        }
+    }
+
+    //! Lança uma exceção caso a escala ou os cortes não formem uma imagem válida
+    static void validar_opcoes(const SaidaOpcoes& opcoes)
+    {
+        if (opcoes.escala < 1 || opcoes.escala > 4)
+        {
+            throw runtime_error("Erro: escala de saída inválida"s);
+        }
+
+        if (opcoes.corte_esquerda < 0 || opcoes.corte_direita < 0 || 
+            opcoes.corte_cima < 0 || opcoes.corte_baixo < 0 ||
+            opcoes.corte_esquerda + opcoes.corte_direita >= TELA_LARGURA ||
+            opcoes.corte_cima + opcoes.corte_baixo >= TELA_ALTURA)
+        {
+            throw runtime_error("Erro: corte de saída inválido"s);
+        }
+    }
+
+    int get_pixel_tamanho(SaidaFormato formato)
+    {
+        switch (formato)
+        {
+            case SaidaFormato::RGB565: return 2;
+            case SaidaFormato::YUV420: return 1;
+            default: return 4;
+        }
+    }
+
+    int get_largura(const SaidaOpcoes& opcoes)
+    {
+        return (TELA_LARGURA - opcoes.corte_esquerda - opcoes.corte_direita) * opcoes.escala;
+    }
+
+    int get_altura(const SaidaOpcoes& opcoes)
+    {
+        return (TELA_ALTURA - opcoes.corte_cima - opcoes.corte_baixo) * opcoes.escala;
+    }
+
+    size_t get_tamanho(const SaidaOpcoes& opcoes, size_t passo)
+    {
+        validar_opcoes(opcoes);
+
+        const size_t largura = get_largura(opcoes);
+        const size_t altura = get_altura(opcoes);
+        if (opcoes.formato == SaidaFormato::YUV420)
+        {
+            return largura*altura + 2 * ((largura + 1) / 2) * ((altura + 1) / 2);
+        }
+
+        const size_t linha_tamanho = largura * get_pixel_tamanho(opcoes.formato);
+        if (passo == 0)
+        {
+            passo = linha_tamanho;
+        }
+
+        return passo*(altura - 1) + linha_tamanho;
+    }
+
+    void set_simd(Simd simd)
+    {
+        if (!is_simd_suportado(simd))
+        {
+            throw runtime_error("Erro: o processador não suporta o conjunto de instruções da saída"s);
+        }
+
+        simd_atual = simd;
+    }
+
+    Simd get_simd()
+    {
+        return simd_atual;
+    }
+
+#if defined(NESBRASA_SIMD_X86)
+    /*! Converte pixels RGB com SSE2, 4 por vez
+        \return Quantidade de pixels convertidos. Os que sobram ficam para a versão escalar
+    */
+    __attribute__((target("sse2")))
+    static int converter_linha_rgb_sse2(const uint32* origem, int quantidade, SaidaFormato formato, void* destino)
+    {
+        using Vetor = __m128i;
+        const int VETOR_PIXELS = 4;
+
+        uint32* destino_32 = static_cast<uint32*>(destino);
+        uint16* destino_16 = static_cast<uint16*>(destino);
+
+        int i = 0;
+        switch (formato)
+        {
+            case SaidaFormato::BGRA8888:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm_loadu_si128(reinterpret_cast<const Vetor*>(origem + i));
+                    vetor_guardar(destino_32 + i, vetor_ou(cor, 0xFF000000));
+                }
+                break;
+
+            case SaidaFormato::RGBA8888:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm_loadu_si128(reinterpret_cast<const Vetor*>(origem + i));
+                    const Vetor r = vetor_e(vetor_direita(cor, 16), 0x0000FF);
+                    const Vetor b = vetor_esquerda(vetor_e(cor, 0x0000FF), 16);
+                    const Vetor g = vetor_e(cor, 0x00FF00);
+                    vetor_guardar(destino_32 + i, vetor_ou(vetor_ou(vetor_ou(r, g), b), 0xFF000000));
+                }
+                break;
+
+            case SaidaFormato::RGB565:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm_loadu_si128(reinterpret_cast<const Vetor*>(origem + i));
+                    const Vetor r = vetor_e(vetor_direita(cor, 8), 0xF800);
+                    const Vetor g = vetor_e(vetor_direita(cor, 5), 0x07E0);
+                    const Vetor b = vetor_e(vetor_direita(cor, 3), 0x001F);
+                    vetor_guardar_16(destino_16 + i, vetor_ou(vetor_ou(r, g), b));
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        return i;
+    }
+
+    /*! Converte pixels RGB com AVX2, 8 por vez
+        \return Quantidade de pixels convertidos. Os que sobram ficam para a versão escalar
+    */
+    __attribute__((target("avx2")))
+    static int converter_linha_rgb_avx2(const uint32* origem, int quantidade, SaidaFormato formato, void* destino)
+    {
+        using Vetor = __m256i;
+        const int VETOR_PIXELS = 8;
+
+        uint32* destino_32 = static_cast<uint32*>(destino);
+        uint16* destino_16 = static_cast<uint16*>(destino);
+
+        int i = 0;
+        switch (formato)
+        {
+            case SaidaFormato::BGRA8888:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm256_loadu_si256(reinterpret_cast<const Vetor*>(origem + i));
+                    vetor_guardar(destino_32 + i, vetor_ou(cor, 0xFF000000));
+                }
+                break;
+
+            case SaidaFormato::RGBA8888:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm256_loadu_si256(reinterpret_cast<const Vetor*>(origem + i));
+                    const Vetor r = vetor_e(vetor_direita(cor, 16), 0x0000FF);
+                    const Vetor b = vetor_esquerda(vetor_e(cor, 0x0000FF), 16);
+                    const Vetor g = vetor_e(cor, 0x00FF00);
+                    vetor_guardar(destino_32 + i, vetor_ou(vetor_ou(vetor_ou(r, g), b), 0xFF000000));
+                }
+                break;
+
+            case SaidaFormato::RGB565:
+                for (; i + VETOR_PIXELS <= quantidade; i += VETOR_PIXELS)
+                {
+                    const Vetor cor = _mm256_loadu_si256(reinterpret_cast<const Vetor*>(origem + i));
+                    const Vetor r = vetor_e(vetor_direita(cor, 8), 0xF800);
+                    const Vetor g = vetor_e(vetor_direita(cor, 5), 0x07E0);
+                    const Vetor b = vetor_e(vetor_direita(cor, 3), 0x001F);
+                    vetor_guardar_16(destino_16 + i, vetor_ou(vetor_ou(r, g), b));
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        return i;
+    }
+#endif
+
+    //! Converte pixels RGB no formato de 'Textura' para um formato de 1 plano
+    static void converter_linha_rgb(const uint32* origem, int quantidade, SaidaFormato formato, void* destino)
+    {
+        uint32* destino_32 = static_cast<uint32*>(destino);
+        uint16* destino_16 = static_cast<uint16*>(destino);
+
+        int i = 0;
+#if defined(NESBRASA_SIMD_X86)
+        switch (simd_atual)
+        {
+            case Simd::AVX2: i = converter_linha_rgb_avx2(origem, quantidade, formato, destino); break;
+            case Simd::SSE2: i = converter_linha_rgb_sse2(origem, quantidade, formato, destino); break;
+            default: break;
+        }
+#endif
+
+        switch (formato)
+        {
+            case SaidaFormato::BGRA8888:
+                // 0x00RRGGBB já fica na ordem B, G, R na memória, falta apenas o alfa
+                for (; i < quantidade; i++)
+                {
+                    destino_32[i] = origem[i] | 0xFF000000;
+                }
+                break;
+
+            case SaidaFormato::RGBA8888:
+                // troca o vermelho com o azul
+                for (; i < quantidade; i++)
+                {
+                    const uint32 cor = origem[i];
+                    destino_32[i] = ((cor >> 16) & 0xFF) | (cor & 0xFF00) | ((cor & 0xFF) << 16) | 0xFF000000;
+                }
+                break;
+
+            case SaidaFormato::RGB565:
+                for (; i < quantidade; i++)
+                {
+                    const uint32 cor = origem[i];
+                    destino_16[i] = ((cor >> 8) & 0xF800) | ((cor >> 5) & 0x07E0) | ((cor >> 3) & 0x001F);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+#if defined(NESBRASA_SIMD_X86)
+    /*! Calcula o plano Y de uma linha de pixels RGB com SSE2
+        \return Quantidade de pixels convertidos. Os que sobram ficam para a versão escalar
+    */
+    __attribute__((target("sse2")))
+    static int converter_linha_y_sse2(const uint32* origem, int quantidade, byte* destino)
+    {
+        // 8 pixels por vez, com os componentes em 16 bits. A soma cabe em 16 bits sem sinal
+        int i = 0;
+        const __m128i mascara = _mm_set1_epi32(0xFF);
+        for (; i + 8 <= quantidade; i += 8)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(origem + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(origem + i + 4));
+
+            const __m128i r16 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 16), mascara), 
+                                                _mm_and_si128(_mm_srli_epi32(b, 16), mascara));
+            const __m128i g16 = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(a, 8), mascara), 
+                                                _mm_and_si128(_mm_srli_epi32(b, 8), mascara));
+            const __m128i b16 = _mm_packs_epi32(_mm_and_si128(a, mascara), _mm_and_si128(b, mascara));
+
+            __m128i y = _mm_add_epi16(_mm_mullo_epi16(r16, _mm_set1_epi16(66)), 
+                                      _mm_mullo_epi16(g16, _mm_set1_epi16(129)));
+            y = _mm_add_epi16(y, _mm_mullo_epi16(b16, _mm_set1_epi16(25)));
+            y = _mm_add_epi16(y, _mm_set1_epi16(128));
+            y = _mm_add_epi16(_mm_srli_epi16(y, 8), _mm_set1_epi16(16));
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destino + i), _mm_packus_epi16(y, y));
+        }
+
+        return i;
+    }
+#endif
+
+    //! Calcula o plano Y de uma linha de pixels RGB
+    static void converter_linha_y(const uint32* origem, int quantidade, byte* destino)
+    {
+        int i = 0;
+#if defined(NESBRASA_SIMD_X86)
+        // o AVX2 também usa a versão SSE2, que já processa 8 pixels por vez
+        if (simd_atual != Simd::ESCALAR)
+        {
+            i = converter_linha_y_sse2(origem, quantidade, destino);
+        }
+#endif
+        for (; i < quantidade; i++)
+        {
+            const int r = (origem[i] >> 16) & 0xFF;
+            const int g = (origem[i] >> 8) & 0xFF;
+            const int b = origem[i] & 0xFF;
+            destino[i] = static_cast<byte>(((66*r + 129*g + 25*b + 128) >> 8) + 16);
+        }
+    }
+
+    //! Calcula U e V a partir da média de um bloco de 2x2 pixels RGB
+    static inline void converter_bloco_uv(int r, int g, int b, byte* u, byte* v)
+    {
+        r = (r + 2) / 4;
+        g = (g + 2) / 4;
+        b = (b + 2) / 4;
+
+        // o deslocamento de 128 << 8 mantém as somas positivas antes do shift
+        *u = static_cast<byte>((-38*r - 74*g + 112*b + 128 + (128 << 8)) >> 8);
+        *v = static_cast<byte>((112*r - 94*g - 18*b + 128 + (128 << 8)) >> 8);
+    }
+
+#if defined(NESBRASA_SIMD_X86)
+    //! Soma um componente dos pixels de 2 linhas
+    __attribute__((target("sse2")))
+    static inline __m128i componente(__m128i a, __m128i b, int bits)
+    {
+        const __m128i mascara = _mm_set1_epi32(0xFF);
+        return _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(a, bits), mascara), 
+                             _mm_and_si128(_mm_srli_epi32(b, bits), mascara));
+    }
+
+    //! Soma os pares de pixels vizinhos, formando a soma de cada bloco
+    __attribute__((target("sse2")))
+    static inline __m128i somar_pares(__m128i a, __m128i b)
+    {
+        const __m128 pares_a = _mm_castsi128_ps(a);
+        const __m128 pares_b = _mm_castsi128_ps(b);
+        const __m128i pares = _mm_castps_si128(_mm_shuffle_ps(pares_a, pares_b, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i impares = _mm_castps_si128(_mm_shuffle_ps(pares_a, pares_b, _MM_SHUFFLE(3, 1, 3, 1)));
+        return _mm_add_epi32(pares, impares);
+    }
+
+    //! Média arredondada das somas dos blocos, em 16 bits
+    __attribute__((target("sse2")))
+    static inline __m128i media(__m128i soma)
+    {
+        soma = _mm_srli_epi32(_mm_add_epi32(soma, _mm_set1_epi32(2)), 2);
+        return _mm_packs_epi32(soma, soma);
+    }
+
+    /*! Calcula os planos U e V de um par de linhas com SSE2, 4 blocos por vez enquanto
+        os 8 pixels dos blocos estiverem dentro da linha
+        \return Quantidade de blocos convertidos. Os que sobram ficam para a versão escalar
+    */
+    __attribute__((target("sse2")))
+    static int converter_linha_uv_sse2(const uint32* linha_0, const uint32* linha_1, int largura, 
+                                       byte* plano_u, byte* plano_v)
+    {
+        const int croma_largura = (largura + 1) / 2;
+
+        int x = 0;
+        for (; x + 4 <= croma_largura && x*2 + 8 <= largura; x += 4)
+        {
+            const __m128i a_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linha_0 + x*2));
+            const __m128i a_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linha_0 + x*2 + 4));
+            const __m128i b_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linha_1 + x*2));
+            const __m128i b_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(linha_1 + x*2 + 4));
+
+            const __m128i r = media(somar_pares(componente(a_0, b_0, 16), componente(a_1, b_1, 16)));
+            const __m128i g = media(somar_pares(componente(a_0, b_0, 8), componente(a_1, b_1, 8)));
+            const __m128i b = media(somar_pares(componente(a_0, b_0, 0), componente(a_1, b_1, 0)));
+
+            // os resultados ficam entre 0 e 0xFFFF, então as operações em 16 bits sem sinal são exatas
+            __m128i u = _mm_sub_epi16(_mm_mullo_epi16(b, _mm_set1_epi16(112)), 
+                                      _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(38)), 
+                                                    _mm_mullo_epi16(g, _mm_set1_epi16(74))));
+            __m128i v = _mm_sub_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(112)), 
+                                      _mm_add_epi16(_mm_mullo_epi16(g, _mm_set1_epi16(94)), 
+                                                    _mm_mullo_epi16(b, _mm_set1_epi16(18))));
+            const __m128i deslocamento = _mm_set1_epi16(static_cast<short>(128 + (128 << 8)));
+            u = _mm_srli_epi16(_mm_add_epi16(u, deslocamento), 8);
+            v = _mm_srli_epi16(_mm_add_epi16(v, deslocamento), 8);
+
+            const int u_bytes = _mm_cvtsi128_si32(_mm_packus_epi16(u, u));
+            const int v_bytes = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+            std::memcpy(plano_u + x, &u_bytes, 4);
+            std::memcpy(plano_v + x, &v_bytes, 4);
+        }
+
+        return x;
+    }
+#endif
+
+    //! Calcula os planos U e V de um par de linhas de pixels RGB
+    static void converter_linha_uv(const uint32* linha_0, const uint32* linha_1, int largura, 
+                                   byte* plano_u, byte* plano_v)
+    {
+        const int croma_largura = (largura + 1) / 2;
+
+        int x = 0;
+#if defined(NESBRASA_SIMD_X86)
+        if (simd_atual != Simd::ESCALAR)
+        {
+            x = converter_linha_uv_sse2(linha_0, linha_1, largura, plano_u, plano_v);
+        }
+#endif
+        for (; x < croma_largura; x++)
+        {
+            const int x0 = x*2;
+            const int x1 = std::min(x0 + 1, largura - 1);
+            const uint32 bloco[4] = { linha_0[x0], linha_0[x1], linha_1[x0], linha_1[x1] };
+
+            int r = 0, g = 0, b = 0;
+            for (uint32 cor : bloco)
+            {
+                r += (cor >> 16) & 0xFF;
+                g += (cor >> 8) & 0xFF;
+                b += cor & 0xFF;
+            }
+            converter_bloco_uv(r, g, b, plano_u + x, plano_v + x);
+        }
+    }
+
+    //! Repete cada pixel da linha 'ESCALA' vezes
+    template <typename T, int ESCALA>
+    static void ampliar_linha(const T* origem, int quantidade, T* destino)
+    {
+        for (int i = 0; i < quantidade; i++)
+        {
+            for (int j = 0; j < ESCALA; j++)
+            {
+                destino[i*ESCALA + j] = origem[i];
+            }
+        }
+    }
+
+    template <typename T>
+    static void ampliar_linha(const T* origem, int quantidade, int escala, T* destino)
+    {
+        switch (escala)
+        {
+            case 2: ampliar_linha<T, 2>(origem, quantidade, destino); break;
+            case 3: ampliar_linha<T, 3>(origem, quantidade, destino); break;
+            case 4: ampliar_linha<T, 4>(origem, quantidade, destino); break;
+            default: std::memcpy(destino, origem, quantidade*sizeof(T)); break;
+        }
+    }
+
+    /*! Converte a tela para um dos formatos de 1 plano
+        \param converter_linha Converte os pixels de uma linha da tela, já cortada, para o formato
+    */
+    template <typename ConverterLinha>
+    static void converter_compacto(ConverterLinha converter_linha, void* destino, 
+                                   const SaidaOpcoes& opcoes, size_t passo)
+    {
+        const int pixel_tamanho = get_pixel_tamanho(opcoes.formato);
+        const int origem_largura = TELA_LARGURA - opcoes.corte_esquerda - opcoes.corte_direita;
+        const size_t linha_tamanho = get_largura(opcoes) * pixel_tamanho;
+        if (passo == 0)
+        {
+            passo = linha_tamanho;
+        }
+
+        vector<uint32> convertida(origem_largura);
+        byte* saida = static_cast<byte*>(destino);
+        for (int y = opcoes.corte_cima; y < TELA_ALTURA - opcoes.corte_baixo; y++)
+        {
+            byte* primeira = saida;
+            if (opcoes.escala == 1)
+            {
+                converter_linha(y, primeira);
+            }
+            else
+            {
+                converter_linha(y, convertida.data());
+                if (pixel_tamanho == 4)
+                {
+                    ampliar_linha(convertida.data(), origem_largura, opcoes.escala, 
+                                  reinterpret_cast<uint32*>(primeira));
+                }
+                else
+                {
+                    ampliar_linha(reinterpret_cast<const uint16*>(convertida.data()), origem_largura, 
+                                  opcoes.escala, reinterpret_cast<uint16*>(primeira));
+                }
+            }
+            saida += passo;
+
+            // as linhas ampliadas são cópias da primeira
+            for (int i = 1; i < opcoes.escala; i++)
+            {
+                std::memcpy(saida, primeira, linha_tamanho);
+                saida += passo;
+            }
+        }
+    }
+
+    /*! Converte a tela para o YUV420
+        \param linha_rgb Busca os pixels RGB de uma linha da tela, já cortada. As 2 linhas
+                         usadas ao mesmo tempo são buscadas com índices diferentes (0 e 1)
+    */
+    template <typename LinhaRgb>
+    static void converter_yuv420(LinhaRgb linha_rgb, void* destino, const SaidaOpcoes& opcoes)
+    {
+        const int largura = get_largura(opcoes);
+        const int altura = get_altura(opcoes);
+        const int origem_largura = TELA_LARGURA - opcoes.corte_esquerda - opcoes.corte_direita;
+        const int croma_largura = (largura + 1) / 2;
+        const int croma_altura = (altura + 1) / 2;
+
+        byte* plano_y = static_cast<byte*>(destino);
+        byte* plano_u = plano_y + largura*altura;
+        byte* plano_v = plano_u + croma_largura*croma_altura;
+
+        vector<uint32> ampliadas[2] = { vector<uint32>(largura), vector<uint32>(largura) };
+        auto linha_ampliada = [&](int y, int i) -> const uint32*
+        {
+            const uint32* linha = linha_rgb(opcoes.corte_cima + y / opcoes.escala, i);
+            if (opcoes.escala == 1)
+            {
+                return linha;
+            }
+
+            ampliar_linha(linha, origem_largura, opcoes.escala, ampliadas[i].data());
+            return ampliadas[i].data();
+        };
+
+        for (int y = 0; y < altura; y += 2)
+        {
+            const uint32* linha_0 = linha_ampliada(y, 0);
+            converter_linha_y(linha_0, largura, plano_y + y*largura);
+
+            // a última linha é repetida nas imagens com altura ímpar
+            const uint32* linha_1 = linha_0;
+            if (y + 1 < altura)
+            {
+                // nas escalas pares as 2 linhas são cópias da mesma linha da tela
+                if ((y + 1) / opcoes.escala == y / opcoes.escala)
+                {
+                    std::memcpy(plano_y + (y + 1)*largura, plano_y + y*largura, largura);
+                }
+                else
+                {
+                    linha_1 = linha_ampliada(y + 1, 1);
+                    converter_linha_y(linha_1, largura, plano_y + (y + 1)*largura);
+                }
+            }
+
+            // o croma usa a média de cada bloco de 2x2 pixels
+            converter_linha_uv(linha_0, linha_1, largura, 
+                               plano_u + (y / 2)*croma_largura, plano_v + (y / 2)*croma_largura);
+        }
+    }
+
+    void converter_textura(const uint32* textura, void* destino, const SaidaOpcoes& opcoes, size_t passo)
+    {
+        validar_opcoes(opcoes);
+
+        auto linha_rgb = [&](int y, int)
+        {
+            return textura + y*TELA_LARGURA + opcoes.corte_esquerda;
+        };
+
+        if (opcoes.formato == SaidaFormato::YUV420)
+        {
+            converter_yuv420(linha_rgb, destino, opcoes);
+            return;
+        }
+
+        const int quantidade = TELA_LARGURA - opcoes.corte_esquerda - opcoes.corte_direita;
+        auto converter_linha = [&](int y, void* saida)
+        {
+            converter_linha_rgb(linha_rgb(y, 0), quantidade, opcoes.formato, saida);
+        };
+        converter_compacto(converter_linha, destino, opcoes, passo);
+    }
+
+    void converter_textura_indices(const uint16* indices, void* destino, const SaidaOpcoes& opcoes, size_t passo)
+    {
+        validar_opcoes(opcoes);
+
+        const int quantidade = TELA_LARGURA - opcoes.corte_esquerda - opcoes.corte_direita;
+        if (opcoes.formato == SaidaFormato::YUV420)
+        {
+            // o YUV é calculado a partir das cores RGB
+            vector<uint32> rgb[2] = { vector<uint32>(quantidade), vector<uint32>(quantidade) };
+            auto linha_rgb = [&](int y, int indice)
+            {
+                const uint16* linha = indices + y*TELA_LARGURA + opcoes.corte_esquerda;
+                for (int i = 0; i < quantidade; i++)
+                {
+                    rgb[indice][i] = cores::tabela_rgb_enfase[linha[i] & 0x1FF];
+                }
+                return static_cast<const uint32*>(rgb[indice].data());
+            };
+
+            converter_yuv420(linha_rgb, destino, opcoes);
+            return;
+        }
+
+        auto converter_linha = [&](int y, void* saida)
+        {
+            converter_indices(indices + y*TELA_LARGURA + opcoes.corte_esquerda, quantidade, opcoes.formato, saida);
+        };
+        converter_compacto(converter_linha, destino, opcoes, passo);
+    }
+
+#if defined(NESBRASA_SIMD_X86)
+    /*! Converte índices de 'cores::tabela_rgb_enfase' com AVX2
+        \return Quantidade de pixels convertidos. Os que sobram ficam para a versão escalar
+    */
+    __attribute__((target("avx2")))
+    static size_t converter_indices_avx2(const uint16* indices, size_t quantidade, 
+                                         const array<uint32, 0x200>& tabela, bool pixel_16, void* destino)
+    {
+        uint32* destino_32 = static_cast<uint32*>(destino);
+        uint16* destino_16 = static_cast<uint16*>(destino);
+
+        size_t i = 0;
+        // 16 pixels por vez, buscando os valores de 8 em 8 na tabela
+        const int* tabela_ptr = reinterpret_cast<const int*>(tabela.data());
+        const __m256i mascara = _mm256_set1_epi16(0x1FF);
+        for (; i + 16 <= quantidade; i += 16)
+        {
+            __m256i valores = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+            valores = _mm256_and_si256(valores, mascara);
+
+            const __m256i indices_1 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(valores));
+            const __m256i indices_2 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(valores, 1));
+            const __m256i pixels_1 = _mm256_i32gather_epi32(tabela_ptr, indices_1, 4);
+            const __m256i pixels_2 = _mm256_i32gather_epi32(tabela_ptr, indices_2, 4);
+
+            if (pixel_16)
+            {
+                // 'packus' junta as metades de 128 bits intercaladas, que são reordenadas
+                __m256i pixels = _mm256_packus_epi32(pixels_1, pixels_2);
+                pixels = _mm256_permute4x64_epi64(pixels, 0xD8);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino_16 + i), pixels);
+            }
+            else
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino_32 + i), pixels_1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(destino_32 + i + 8), pixels_2);
+            }
+        }
+
+        return i;
+    }
+#endif
+
+    void converter_indices(const uint16* indices, size_t quantidade, SaidaFormato formato, void* destino)
+    {
+        if (formato == SaidaFormato::YUV420)
+        {
+            throw runtime_error("Erro: formato de saída inválido para a conversão de índices"s);
+        }
+
+        const array<uint32, 0x200>& tabela = buscar_tabela(formato);
+        const bool pixel_16 = get_pixel_tamanho(formato) == 2;
+        uint32* destino_32 = static_cast<uint32*>(destino);
+        uint16* destino_16 = static_cast<uint16*>(destino);
+
+        size_t i = 0;
+#if defined(NESBRASA_SIMD_X86)
+        if (simd_atual == Simd::AVX2)
+        {
+            i = converter_indices_avx2(indices, quantidade, tabela, pixel_16, destino);
+        }
+#endif
+
+        if (pixel_16)
+        {
+            for (; i < quantidade; i++)
+            {
+                destino_16[i] = static_cast<uint16>(tabela[indices[i] & 0x1FF]);
+            }
+        }
+        else
+        {
+            for (; i < quantidade; i++)
+            {
+                destino_32[i] = tabela[indices[i] & 0x1FF];
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+/* saida.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "simd.hpp"
+#include "tipos_numeros.hpp"
+
+// referencias utilizadas:
+// https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+
+namespace nesbrasa::nucleo::saida
+{
+    using namespace nesbrasa::tipos;
+
+    //! Formatos dos pixels produzidos pelas conversões
+    enum class SaidaFormato
+    {
+        // 4 bytes por pixel, na ordem R, G, B, A
+        RGBA8888,
+        // 4 bytes por pixel, na ordem B, G, R, A
+        BGRA8888,
+        // 2 bytes por pixel, com o vermelho nos 5 bits mais significativos
+        RGB565,
+        // 3 planos de 1 byte por pixel (Y, U e V nessa ordem, como no I420), com U e V
+        // na metade da resolução nos dois eixos. Usa o BT.601 com faixa limitada
+        YUV420,
+    };
+
+    //! Como a tela é convertida por 'converter_textura' e 'converter_textura_indices'
+    struct SaidaOpcoes
+    {
+        SaidaFormato formato;
+        int escala; // fator de ampliação por vizinho mais próximo, de 1 a 4
+
+        // pixels da tela de 256x240 removidos em cada borda antes da ampliação
+        int corte_esquerda;
+        int corte_direita;
+        int corte_cima;
+        int corte_baixo;
+    };
+
+    /*! Quantidade de bytes usados por um pixel no formato, 
+        no caso do YUV420 apenas no plano Y
+    */
+    int get_pixel_tamanho(SaidaFormato formato);
+
+    //! Largura em pixels da imagem produzida com as opções
+    int get_largura(const SaidaOpcoes& opcoes);
+    //! Altura em pixels da imagem produzida com as opções
+    int get_altura(const SaidaOpcoes& opcoes);
+
+    /*! Quantidade de bytes que o destino de uma conversão precisa ter
+        \param passo Bytes entre o início de duas linhas do destino, 0 para linhas contíguas
+    */
+    size_t get_tamanho(const SaidaOpcoes& opcoes, size_t passo = 0);
+
+    /*! Escolhe o conjunto de instruções usado pelas próximas conversões. O padrão é o
+        mais completo suportado pelo processador, checado durante a execução. Lança uma
+        exceção caso o processador não suporte o conjunto de instruções
+    */
+    void set_simd(Simd simd);
+
+    //! Retorna o conjunto de instruções usado pelas conversões
+    Simd get_simd();
+
+    /*! Converte uma textura RGB produzida pela ppu, cortando e ampliando a imagem.
+        Usa o conjunto de instruções escolhido por 'set_simd'. Lança uma exceção caso
+        as opções sejam inválidas
+        \param textura Os 256x240 pixels RGB no formato de 'Textura'
+        \param destino Buffer fornecido pelo usuário, com pelo menos 'get_tamanho' bytes
+        \param passo Bytes entre o início de duas linhas do destino, 0 para linhas contíguas.
+                     É ignorado no formato YUV420, em que os planos são sempre contíguos
+    */
+    void converter_textura(const uint32* textura, void* destino, const SaidaOpcoes& opcoes, size_t passo = 0);
+
+    //! Igual a 'converter_textura', para uma textura do modo de vídeo 'INDICES'
+    void converter_textura_indices(const uint16* indices, void* destino, const SaidaOpcoes& opcoes, size_t passo = 0);
+
+    /*! Converte os índices de cores produzidos pela ppu no modo de vídeo 'INDICES'
+        para o formato. Só o AVX2 tem uma versão SIMD, os outros conjuntos usam a escalar
+        \param indices Índices de 'cores::tabela_rgb_enfase', no formato de 'TexturaIndices'
+        \param quantidade Quantidade de pixels a serem convertidos
+        \param formato Formato dos pixels produzidos, exceto YUV420
+        \param destino Buffer com pelo menos quantidade*get_pixel_tamanho(formato) bytes
+    */
+    void converter_indices(const uint16* indices, size_t quantidade, SaidaFormato formato, void* destino);
+}
\ No newline at end of file
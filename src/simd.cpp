@@ -0,0 +1,45 @@
+/* simd.cpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simd.hpp"
+
+namespace nesbrasa::nucleo
+{
+    Simd get_simd_disponivel()
+    {
+#if defined(NESBRASA_SIMD_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return Simd::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return Simd::SSE2;
+        }
+#endif
+
+        return Simd::ESCALAR;
+    }
+
+    bool is_simd_suportado(Simd simd)
+    {
+        // cada conjunto de instruções inclui os anteriores
+        return static_cast<int>(simd) <= static_cast<int>(get_simd_disponivel());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/* simd.hpp
+ *
+ * Copyright 2019 Roberto Nazareth <nazarethroberto97@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// as versões SIMD usam o atributo 'target' do GCC e do Clang, que permite compilá-las
+// sem '-mavx2' e escolher a versão usada de acordo com o processador em que o código roda
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define NESBRASA_SIMD_X86
+#endif
+
+namespace nesbrasa::nucleo
+{
+    //! Conjuntos de instruções das versões SIMD do compositor e da conversão de saída
+    enum class Simd
+    {
+        ESCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    //! Retorna o conjunto de instruções mais completo suportado pelo processador
+    Simd get_simd_disponivel();
+
+    //! Checa se o processador suporta o conjunto de instruções
+    bool is_simd_suportado(Simd simd);
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include <array>
+#include <cstdlib>
+#include <random>
+
+#include "compositor.hpp"
+
+using nesbrasa::nucleo::Simd;
+using nesbrasa::nucleo::is_simd_suportado;
+using namespace nesbrasa::nucleo::compositor;
+using nesbrasa::tipos::byte;
+using nesbrasa::tipos::uint16;
+using nesbrasa::tipos::uint32;
+using std::array;
+
+static const int LINHA_LARGURA = 256;
+
+// a referência compõe um pixel por vez com 'compor_pixel'
+static bool testar_linha(const array<byte, LINHA_LARGURA>& fundo, const array<byte, LINHA_LARGURA>& sprites,
+                         const array<uint32, 0x20>& paleta_rgb, const array<uint16, 0x20>& paleta_indices,
+                         bool fundo_esquerda, bool sprites_esquerda)
+{
+    array<byte, LINHA_LARGURA> cores;
+    bool sprite_zero = false;
+    for (int x = 0; x < LINHA_LARGURA; x++)
+    {
+        const byte f = (x < 8 && !fundo_esquerda) ? 0 : fundo[x];
+        const byte s = (x < 8 && !sprites_esquerda) ? 0 : sprites[x];
+
+        bool colisao = false;
+        cores[x] = compor_pixel(f, s, colisao);
+        sprite_zero = sprite_zero || (colisao && x < LINHA_LARGURA - 1);
+    }
+
+    array<uint32, LINHA_LARGURA> saida_rgb;
+    if (compor_linha(fundo.data(), sprites.data(), paleta_rgb, saida_rgb.data(),
+                     fundo_esquerda, sprites_esquerda) != sprite_zero)
+    {
+        return false;
+    }
+
+    array<uint16, LINHA_LARGURA> saida_indices;
+    if (compor_linha_indices(fundo.data(), sprites.data(), paleta_indices, saida_indices.data(),
+                             fundo_esquerda, sprites_esquerda) != sprite_zero)
+    {
+        return false;
+    }
+
+    for (int x = 0; x < LINHA_LARGURA; x++)
+    {
+        if (saida_rgb[x] != paleta_rgb[cores[x]] || saida_indices[x] != paleta_indices[cores[x]])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    // compara cada conjunto de instruções suportado pelo processador com a composição
+    // pixel a pixel, incluindo as flags dos 8 primeiros pixels e o último pixel da linha
+
+    std::mt19937 gerador(1);
+
+    array<uint32, 0x20> paleta_rgb;
+    array<uint16, 0x20> paleta_indices;
+    for (int i = 0; i < 0x20; i++)
+    {
+        paleta_rgb[i] = gerador() & 0xFFFFFF;
+        paleta_indices[i] = gerador() & 0x1FF;
+    }
+
+    for (auto simd : { Simd::ESCALAR, Simd::SSE2, Simd::AVX2 })
+    {
+        if (!is_simd_suportado(simd))
+        {
+            continue;
+        }
+        set_simd(simd);
+
+        for (int teste = 0; teste < 2000; teste++)
+        {
+            array<byte, LINHA_LARGURA> fundo;
+            array<byte, LINHA_LARGURA> sprites;
+            for (int x = 0; x < LINHA_LARGURA; x++)
+            {
+                fundo[x] = gerador() & 0x0F;
+                sprites[x] = gerador() & (SPRITE_COR | SPRITE_ATRAS);
+            }
+
+            // um único pixel do sprite 0, para que a colisão dependa da posição dele
+            sprites[gerador() % LINHA_LARGURA] |= SPRITE_ZERO;
+
+            for (bool fundo_esquerda : { false, true })
+            {
+                for (bool sprites_esquerda : { false, true })
+                {
+                    if (!testar_linha(fundo, sprites, paleta_rgb, paleta_indices, fundo_esquerda, sprites_esquerda))
+                    {
+                        return EXIT_FAILURE;
+                    }
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include <memory>
+
+#include "rom_teste.hpp"
+#include "recompilador.hpp"
+
+using nesbrasa::nucleo::CpuNucleo;
+using nesbrasa::nucleo::PpuVideo;
+using nesbrasa::nucleo::Recompilador;
+using std::make_unique;
+
+// código de saída usado pelo meson para indicar que o teste foi pulado
+static const int TESTE_PULADO = 77;
+
+static bool comparar(const vector<byte>& rom, CpuNucleo nucleo, bool lotes)
+{
+    // a imagem não é comparada, então só o que a cpu pode observar é calculado
+    auto blocos = make_unique<Nes>();
+    blocos->carregar_rom(rom);
+    blocos->ppu.set_video(PpuVideo::SPRITE_ZERO);
+
+    auto nativo = make_unique<Nes>();
+    nativo->carregar_rom(rom);
+    nativo->ppu.set_video(PpuVideo::SPRITE_ZERO);
+    nativo->cpu.set_nucleo(nucleo);
+
+    // nos lotes, os blocos nativos não podem passar do limite de ciclos
+    return lotes ? comparar_lotes(*blocos, *nativo) : comparar_execucoes(*blocos, *nativo);
+}
+
+int main()
+{
+    // testa se o código traduzido pelo recompilador tem os mesmos efeitos que o núcleo de blocos
+
+    // o recompilador só gera código para x86-64
+    if (!Recompilador::is_disponivel())
+    {
+        return TESTE_PULADO;
+    }
+
+    auto rom = criar_rom_teste();
+
+    for (auto nucleo : { CpuNucleo::DINAMICO, CpuNucleo::DIFERENCIAL })
+    {
+        if (!comparar(rom, nucleo, false) || !comparar(rom, nucleo, true))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <memory>
+#include <stdexcept>
+
+#include "rom_teste.hpp"
+#include "estatico.hpp"
+
+using nesbrasa::nucleo::CpuNucleo;
+using nesbrasa::nucleo::PpuVideo;
+using nesbrasa::nucleo::ProgramaEstatico;
+using std::make_unique;
+
+// gerado pelo 'nesbrasa-recompilar' a partir da rom de 'rom_teste.hpp' durante a compilação
+namespace nesbrasa::nucleo
+{
+    extern const ProgramaEstatico programa_teste_estatico;
+}
+
+using nesbrasa::nucleo::programa_teste_estatico;
+
+int main()
+{
+    // testa se o programa gerado pelo recompilador estático tem os mesmos efeitos
+    // que o núcleo de blocos
+
+    auto rom = criar_rom_teste();
+
+    // a imagem não é comparada, então só o que a cpu pode observar é calculado
+    auto blocos = make_unique<Nes>();
+    blocos->carregar_rom(rom);
+    blocos->ppu.set_video(PpuVideo::SPRITE_ZERO);
+
+    auto estatico = make_unique<Nes>();
+    estatico->carregar_rom(rom);
+    estatico->ppu.set_video(PpuVideo::SPRITE_ZERO);
+    estatico->cpu.set_nucleo(CpuNucleo::ESTATICO);
+    estatico->cpu.set_programa_estatico(&programa_teste_estatico);
+
+    if (!comparar_execucoes(*blocos, *estatico))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // o programa não pode ser usado com uma ROM PRG diferente da usada na geração
+    auto rom_alterada = rom;
+    rom_alterada[16 + 0x3FF0] ^= 0xFF;
+
+    auto outra = make_unique<Nes>();
+    outra->carregar_rom(rom_alterada);
+    outra->cpu.set_nucleo(CpuNucleo::ESTATICO);
+    try
+    {
+        outra->cpu.set_programa_estatico(&programa_teste_estatico);
+        return EXIT_FAILURE;
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <memory>
+
+#include "rom_teste.hpp"
+
+using nesbrasa::nucleo::PpuRenderizacao;
+using std::make_unique;
+
+// a cada frame, conta quantas leituras de PPUSTATUS são feitas até a colisão do
+// sprite 0 e guarda a contagem e o transbordamento de sprites nas páginas $0300-$0500.
+// A OAM não é alterada, então os 64 sprites ficam na posição (0, 0) usando o tile 0
+static const vector<byte> programa = {
+    // desabilita interrupções
+    0x78,                // reset:  SEI
+    0xD8,                //         CLD
+    0xA2, 0xFF,          //         LDX #$FF
+    0x9A,                //         TXS
+    // X = 0
+    0xE8,                //         INX
+    // desabilita o NMI
+    0x8E, 0x00, 0x20,    //         STX $2000
+    // desabilita a renderização
+    0x8E, 0x01, 0x20,    //         STX $2001
+    // espera 2 vblanks para a ppu ficar pronta
+    0x2C, 0x02, 0x20,    // vb1:    BIT $2002
+    0x10, 0xFB,          //         BPL vb1
+    0x2C, 0x02, 0x20,    // vb2:    BIT $2002
+    0x10, 0xFB,          //         BPL vb2
+    // zera a ram
+    0xA9, 0x00,          //         LDA #$00
+    0x9D, 0x00, 0x00,    // ram:    STA $0000,X
+    0x9D, 0x00, 0x01,    //         STA $0100,X
+    0x9D, 0x00, 0x02,    //         STA $0200,X
+    0x9D, 0x00, 0x03,    //         STA $0300,X
+    0x9D, 0x00, 0x04,    //         STA $0400,X
+    0x9D, 0x00, 0x05,    //         STA $0500,X
+    0x9D, 0x00, 0x06,    //         STA $0600,X
+    0x9D, 0x00, 0x07,    //         STA $0700,X
+    0xE8,                //         INX
+    0xD0, 0xE5,          //         BNE ram
+    // preenche as tabelas de nomes com o tile 1
+    0xA9, 0x20,          //         LDA #$20
+    0x8D, 0x06, 0x20,    //         STA $2006
+    0xA9, 0x00,          //         LDA #$00
+    0x8D, 0x06, 0x20,    //         STA $2006
+    0xA9, 0x01,          //         LDA #$01
+    0xA2, 0x00,          //         LDX #$00
+    0xA0, 0x10,          //         LDY #$10
+    0x8D, 0x07, 0x20,    // nt:     STA $2007
+    0xE8,                //         INX
+    0xD0, 0xFA,          //         BNE nt
+    0x88,                //         DEY
+    0xD0, 0xF7,          //         BNE nt
+    // espera o vblank
+    0x2C, 0x02, 0x20,    // frame:  BIT $2002
+    0x10, 0xFB,          //         BPL frame
+    // muda o scroll vertical a cada frame, mudando a linha da colisão
+    0xA9, 0x00,          //         LDA #$00
+    0x8D, 0x00, 0x20,    //         STA $2000
+    0x8D, 0x05, 0x20,    //         STA $2005
+    0xA5, 0x10,          //         LDA $10
+    0x29, 0x07,          //         AND #$07
+    0x8D, 0x05, 0x20,    //         STA $2005
+    // habilita o fundo e os sprites
+    0xA9, 0x1E,          //         LDA #$1E
+    0x8D, 0x01, 0x20,    //         STA $2001
+    // espera a colisão do frame anterior ser limpa
+    0x2C, 0x02, 0x20,    // limpo:  BIT $2002
+    0x70, 0xFB,          //         BVS limpo
+    // conta as leituras até a colisão
+    0xA2, 0x00,          //         LDX #$00
+    0xA0, 0x00,          //         LDY #$00
+    0xE8,                // col:    INX
+    0xD0, 0x01,          //         BNE col2
+    0xC8,                //         INY
+    0x2C, 0x02, 0x20,    // col2:   BIT $2002
+    0x50, 0xF7,          //         BVC col
+    0x86, 0x11,          //         STX $11
+    0x84, 0x12,          //         STY $12
+    // guarda a contagem e o transbordamento do frame
+    0xAD, 0x02, 0x20,    //         LDA $2002
+    0x29, 0x20,          //         AND #$20
+    0xA4, 0x10,          //         LDY $10
+    0x99, 0x00, 0x05,    //         STA $0500,Y
+    0xA5, 0x11,          //         LDA $11
+    0x99, 0x00, 0x03,    //         STA $0300,Y
+    0xA5, 0x12,          //         LDA $12
+    0x99, 0x00, 0x04,    //         STA $0400,Y
+    0xE6, 0x10,          //         INC $10
+    0x4C, 0x4C, 0xC0,    //         JMP frame
+    0x40,                // nmi:    RTI
+};
+
+static vector<byte> criar_rom()
+{
+    // o tile 0, usado pelos sprites, é opaco em todos os pixels e o tile 1, usado
+    // pelo fundo, apenas na última linha
+    vector<byte> chr(32, 0);
+    for (int i = 0; i < 16; i++)
+    {
+        chr[i] = 0xFF;
+    }
+    chr[16 + 7] = 0xFF;
+    chr[16 + 15] = 0xFF;
+
+    return criar_rom_nrom(programa, 0xC094, 0xC094, chr);
+}
+
+static vector<byte> executar(PpuRenderizacao renderizacao, int frames_pular, bool meio_do_frame)
+{
+    auto nes = make_unique<Nes>();
+    nes->carregar_rom(criar_rom());
+    nes->ppu.set_renderizacao(renderizacao);
+
+    for (int frame = 0; frame < 120; frame++)
+    {
+        nes->executar_frame();
+
+        // desenha um frame e pula os próximos
+        if (frames_pular > 0 && frame % (frames_pular + 1) == 0)
+        {
+            if (meio_do_frame)
+            {
+                // o frame seguinte já começou, então ele é desenhado e só os próximos são pulados
+                nes->executar_ciclos(3000);
+                nes->ppu.pular_frames(frames_pular);
+                if (nes->ppu.is_frame_pulado())
+                {
+                    return {};
+                }
+            }
+            else
+            {
+                nes->ppu.pular_frames(frames_pular);
+            }
+        }
+    }
+
+    vector<byte> ram(0x800);
+    for (int i = 0; i < 0x800; i++)
+    {
+        ram[i] = nes->memoria.ler(i);
+    }
+
+    return ram;
+}
+
+static bool pular_no_meio_do_frame(PpuRenderizacao renderizacao)
+{
+    auto nes = make_unique<Nes>();
+    nes->carregar_rom(criar_rom());
+    nes->ppu.set_renderizacao(renderizacao);
+
+    for (int frame = 0; frame < 10; frame++)
+    {
+        nes->executar_frame();
+    }
+
+    // 'executar_frame' para no início do vblank e a prelinha começa cerca de 2273 ciclos
+    // depois, então o pedido é feito antes, durante e logo depois da prelinha
+    for (uint32 ciclos = 2200; ciclos < 2350; ciclos++)
+    {
+        nes->executar_frame();
+        nes->executar_ciclos(ciclos);
+
+        // o frame em andamento nunca é pulado, apenas os próximos
+        nes->ppu.pular_frames(1);
+        if (nes->ppu.is_frame_pulado())
+        {
+            return false;
+        }
+        nes->ppu.pular_frames(0);
+    }
+
+    return true;
+}
+
+int main()
+{
+    // testa se os frames pulados têm os mesmos efeitos observados pela cpu
+    // que os frames desenhados
+
+    for (auto renderizacao : { PpuRenderizacao::PONTO, PpuRenderizacao::LINHA })
+    {
+        if (!pular_no_meio_do_frame(renderizacao))
+        {
+            return EXIT_FAILURE;
+        }
+
+        auto desenhado = executar(renderizacao, 0, false);
+
+        // o programa precisa ter chegado aos últimos frames e detectado as colisões
+        if (desenhado[0x10] < 100 || desenhado[0x300] == 0 || desenhado[0x500] == 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        for (int frames_pular : { 1, 3 })
+        {
+            for (bool meio_do_frame : { false, true })
+            {
+                if (executar(renderizacao, frames_pular, meio_do_frame) != desenhado)
+                {
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#include <fstream>
+#include <iostream>
+
+#include "rom_teste.hpp"
+
+int main(int argc, char* argv[])
+{
+    // grava a rom de 'rom_teste.hpp', usada pelo meson para gerar o programa do teste estático
+
+    if (argc != 2)
+    {
+        std::cerr << "uso: " << argv[0] << " <rom.nes>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto rom = criar_rom_teste();
+
+    std::ofstream arquivo(argv[1], std::ios::binary);
+    arquivo.write(reinterpret_cast<const char*>(rom.data()), rom.size());
+
+    return arquivo ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
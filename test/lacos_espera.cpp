@@ -0,0 +1,65 @@
+#include <memory>
+
+#include "rom_teste.hpp"
+
+using nesbrasa::nucleo::PpuRenderizacao;
+using nesbrasa::nucleo::PpuVideo;
+using std::make_unique;
+
+static bool comparar(const vector<byte>& rom, PpuRenderizacao renderizacao, bool pular_lacos_espera)
+{
+    // a referência executa cada repetição dos laços de espera com a ppu ponto a ponto
+    auto referencia = make_unique<Nes>();
+    referencia->carregar_rom(rom);
+    referencia->ppu.set_renderizacao(PpuRenderizacao::PONTO);
+    referencia->set_pular_lacos_espera(false);
+
+    auto nes = make_unique<Nes>();
+    nes->carregar_rom(rom);
+    nes->ppu.set_renderizacao(renderizacao);
+    nes->set_pular_lacos_espera(pular_lacos_espera);
+
+    return comparar_execucoes(*referencia, *nes, true);
+}
+
+static bool comparar_limites(const vector<byte>& rom)
+{
+    // as chamadas de 'executar_ciclos' precisam parar no mesmo ciclo com e sem os laços pulados
+    auto referencia = make_unique<Nes>();
+    referencia->carregar_rom(rom);
+    referencia->ppu.set_video(PpuVideo::SPRITE_ZERO);
+    referencia->set_pular_lacos_espera(false);
+
+    auto nes = make_unique<Nes>();
+    nes->carregar_rom(rom);
+    nes->ppu.set_video(PpuVideo::SPRITE_ZERO);
+
+    return comparar_lotes(*referencia, *nes);
+}
+
+int main()
+{
+    // testa se pular os laços de espera e renderizar por linha mantêm a ram, os registradores
+    // e a imagem iguais aos da execução normal. A rotina alterada na ram antes de cada chamada
+    // também testa se os blocos guardados pela cpu são descartados quando o código muda
+
+    auto rom = criar_rom_teste();
+
+    for (auto renderizacao : { PpuRenderizacao::PONTO, PpuRenderizacao::LINHA })
+    {
+        for (bool pular_lacos_espera : { false, true })
+        {
+            if (!comparar(rom, renderizacao, pular_lacos_espera))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (!comparar_limites(rom))
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
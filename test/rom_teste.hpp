@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "nesbrasa.hpp"
+#include "memoria.hpp"
+
+using nesbrasa::nucleo::Nes;
+using nesbrasa::nucleo::NesExecucao;
+using nesbrasa::tipos::byte;
+using nesbrasa::tipos::uint16;
+using nesbrasa::tipos::uint32;
+using nesbrasa::tipos::uint64;
+using std::vector;
+
+// programa usado para comparar núcleos e modos que devem ter os mesmos resultados.
+// Ele altera uma rotina na ram antes de cada chamada, usa os modos indexados e indiretos,
+// cruza páginas e espera o próximo frame com laços de espera que leem a ram e o PPUSTATUS
+static const vector<byte> programa_teste = {
+    // desabilita interrupções, o NMI e a renderização
+    0x78,                // reset:    SEI
+    0xD8,                //           CLD
+    0xA2, 0xFF,          //           LDX #$FF
+    0x9A,                //           TXS
+    0xE8,                //           INX
+    0x8E, 0x00, 0x20,    //           STX $2000
+    0x8E, 0x01, 0x20,    //           STX $2001
+    // espera 2 vblanks para a ppu ficar pronta
+    0x2C, 0x02, 0x20,    // vb1:      BIT $2002
+    0x10, 0xFB,          //           BPL vb1
+    0x2C, 0x02, 0x20,    // vb2:      BIT $2002
+    0x10, 0xFB,          //           BPL vb2
+    // zera a ram
+    0xA9, 0x00,          //           LDA #$00
+    0x9D, 0x00, 0x00,    // ram:      STA $0000,X
+    0x9D, 0x00, 0x01,    //           STA $0100,X
+    0x9D, 0x00, 0x02,    //           STA $0200,X
+    0x9D, 0x00, 0x03,    //           STA $0300,X
+    0x9D, 0x00, 0x04,    //           STA $0400,X
+    0x9D, 0x00, 0x05,    //           STA $0500,X
+    0x9D, 0x00, 0x06,    //           STA $0600,X
+    0x9D, 0x00, 0x07,    //           STA $0700,X
+    0xE8,                //           INX
+    0xD0, 0xE5,          //           BNE ram
+    // preenche a paleta com a tabela
+    0xA9, 0x3F,          //           LDA #$3F
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xA9, 0x00,          //           LDA #$00
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xBD, 0x25, 0xC1,    // pal:      LDA tabela,X
+    0x8D, 0x07, 0x20,    //           STA $2007
+    0xE8,                //           INX
+    0xE0, 0x20,          //           CPX #$20
+    0xD0, 0xF5,          //           BNE pal
+    // preenche a primeira tabela de nomes e a de atributos com 0, 1, 2...
+    0xA9, 0x20,          //           LDA #$20
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xA9, 0x00,          //           LDA #$00
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xA0, 0x04,          //           LDY #$04
+    0xA2, 0x00,          //           LDX #$00
+    0x8E, 0x07, 0x20,    // nt:       STX $2007
+    0xE8,                //           INX
+    0xD0, 0xFA,          //           BNE nt
+    0x88,                //           DEY
+    0xD0, 0xF7,          //           BNE nt
+    // copia a rotina para a ram em $0300
+    0xA2, 0x00,          //           LDX #$00
+    0xBD, 0x1D, 0xC1,    // copia:    LDA rotina,X
+    0x9D, 0x00, 0x03,    //           STA $0300,X
+    0xE8,                //           INX
+    0xE0, 0x08,          //           CPX #$08
+    0xD0, 0xF5,          //           BNE copia
+    // ponteiros usados pelos modos indiretos: ($22) = $04E0 e ($24) = $0480
+    0xA9, 0xE0,          //           LDA #$E0
+    0x85, 0x22,          //           STA $22
+    0xA9, 0x80,          //           LDA #$80
+    0x85, 0x24,          //           STA $24
+    0xA9, 0x04,          //           LDA #$04
+    0x85, 0x23,          //           STA $23
+    0x85, 0x25,          //           STA $25
+    // habilita o NMI, o fundo e os sprites
+    0xA9, 0x80,          //           LDA #$80
+    0x8D, 0x00, 0x20,    //           STA $2000
+    0xA9, 0x1E,          //           LDA #$1E
+    0x8D, 0x01, 0x20,    //           STA $2001
+    // altera o operando imediato da rotina da ram antes de cada chamada
+    0xA0, 0x04,          // main:     LDY #$04
+    0xEE, 0x01, 0x03,    // smc:      INC $0301
+    0x20, 0x00, 0x03,    //           JSR $0300
+    0x88,                //           DEY
+    0xD0, 0xF7,          //           BNE smc
+    // aritmética, deslocamentos e a stack com endereços indexados
+    0xA2, 0x08,          //           LDX #$08
+    0xB5, 0x40,          // trab:     LDA $40,X
+    0x75, 0x41,          //           ADC $41,X
+    0x95, 0x40,          //           STA $40,X
+    0x36, 0x50,          //           ROL $50,X
+    0x56, 0x60,          //           LSR $60,X
+    0x45, 0x20,          //           EOR $20
+    0x48,                //           PHA
+    0x08,                //           PHP
+    0xE9, 0x03,          //           SBC #$03
+    0x28,                //           PLP
+    0x68,                //           PLA
+    0x7D, 0xF8, 0x00,    //           ADC $00F8,X
+    0x9D, 0x00, 0x06,    //           STA $0600,X
+    0xCA,                //           DEX
+    0xD0, 0xE5,          //           BNE trab
+    // modos indiretos, as leituras de ($22),Y cruzam a página a partir de Y = $20
+    0xA0, 0x00,          //           LDY #$00
+    0xB1, 0x22,          // ind:      LDA ($22),Y
+    0x59, 0x25, 0xC1,    //           EOR tabela,Y
+    0x91, 0x24,          //           STA ($24),Y
+    0xC8,                //           INY
+    0xC0, 0x40,          //           CPY #$40
+    0xD0, 0xF4,          //           BNE ind
+    0xA2, 0x04,          //           LDX #$04
+    0xA1, 0x20,          //           LDA ($20,X)
+    0x20, 0xD9, 0xC0,    //           JSR sub
+    // nos frames ímpares, espera a colisão do sprite 0 lendo o PPUSTATUS
+    0xA5, 0x10,          //           LDA $10
+    0x4A,                //           LSR A
+    0x90, 0x0A,          //           BCC espera
+    0x2C, 0x02, 0x20,    // sprite0:  BIT $2002
+    0x70, 0xFB,          //           BVS sprite0
+    0x2C, 0x02, 0x20,    // s0b:      BIT $2002
+    0x50, 0xFB,          //           BVC s0b
+    // espera o próximo frame lendo a ram
+    0xA5, 0x10,          // espera:   LDA $10
+    0xC5, 0x10,          // ramesp:   CMP $10
+    0xF0, 0xFC,          //           BEQ ramesp
+    0x4C, 0x84, 0xC0,    //           JMP main
+    // comparações e flags
+    0x0A,                // sub:      ASL A
+    0x66, 0x30,          //           ROR $30
+    0x24, 0x30,          //           BIT $30
+    0x50, 0x02,          //           BVC sub1
+    0xE6, 0x31,          //           INC $31
+    0x30, 0x02,          // sub1:     BMI sub2
+    0xC6, 0x32,          //           DEC $32
+    0xC5, 0x33,          // sub2:     CMP $33
+    0x90, 0x02,          //           BCC sub3
+    0x85, 0x33,          //           STA $33
+    0x60,                // sub3:     RTS
+    // conta os frames, altera uma cor da paleta e o scroll
+    0x48,                // nmi:      PHA
+    0x8A,                //           TXA
+    0x48,                //           PHA
+    0xE6, 0x10,          //           INC $10
+    0xA9, 0x3F,          //           LDA #$3F
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xA9, 0x01,          //           LDA #$01
+    0x8D, 0x06, 0x20,    //           STA $2006
+    0xA5, 0x10,          //           LDA $10
+    0x29, 0x3F,          //           AND #$3F
+    0x8D, 0x07, 0x20,    //           STA $2007
+    0xA5, 0x10,          //           LDA $10
+    0x29, 0x01,          //           AND #$01
+    0x09, 0x80,          //           ORA #$80
+    0x8D, 0x00, 0x20,    //           STA $2000
+    0xA5, 0x12,          //           LDA $12
+    0x8D, 0x05, 0x20,    //           STA $2005
+    0x8D, 0x05, 0x20,    //           STA $2005
+    0x18,                //           CLC
+    0x69, 0x03,          //           ADC #$03
+    0x85, 0x12,          //           STA $12
+    0x68,                //           PLA
+    0xAA,                //           TAX
+    0x68,                //           PLA
+    0x40,                // irq:      RTI
+    // rotina copiada para a ram: LDA #$00; CLC; ADC $20; STA $20; RTS
+    0xA9, 0x00, 0x18, 0x65, 0x20, 0x85, 0x20, 0x60,
+    // paleta, também usada como dados pelos modos indiretos
+    0x0F, 0x01, 0x11, 0x21, 0x0F, 0x06, 0x16, 0x26,
+    0x0F, 0x09, 0x19, 0x29, 0x0F, 0x02, 0x12, 0x22,
+    0x0F, 0x30, 0x27, 0x15, 0x0F, 0x2A, 0x1A, 0x0A,
+    0x0F, 0x24, 0x14, 0x04, 0x0F, 0x38, 0x28, 0x18,
+};
+
+/*! Cria uma rom NROM com 16 KiB de PRG e 8 KiB de CHR. A PRG é mapeada em $C000-$FFFF
+    e o reset começa no início do programa
+    \param programa Código gravado a partir de $C000
+    \param nmi Endereço do tratamento do NMI
+    \param irq Endereço do tratamento do IRQ e do BRK
+    \param chr Início da CHR, o resto é preenchido com zeros
+*/
+inline vector<byte> criar_rom_nrom(const vector<byte>& programa, uint16 nmi, uint16 irq, const vector<byte>& chr)
+{
+    vector<byte> rom(16 + 0x4000 + 0x2000, 0);
+    rom[0] = 'N';
+    rom[1] = 'E';
+    rom[2] = 'S';
+    rom[3] = 0x1A;
+    rom[4] = 1;
+    rom[5] = 1;
+
+    if (programa.size() > 0x4000 - 6 || chr.size() > 0x2000)
+    {
+        throw std::runtime_error("Erro: programa ou CHR maior que a rom de teste");
+    }
+
+    std::copy(programa.begin(), programa.end(), rom.begin() + 16);
+    std::copy(chr.begin(), chr.end(), rom.begin() + 16 + 0x4000);
+
+    // vetores do NMI, do reset e do IRQ
+    const int vetores = 16 + 0x3FFA;
+    rom[vetores + 0] = nmi & 0xFF;
+    rom[vetores + 1] = nmi >> 8;
+    rom[vetores + 2] = 0x00;
+    rom[vetores + 3] = 0xC0;
+    rom[vetores + 4] = irq & 0xFF;
+    rom[vetores + 5] = irq >> 8;
+
+    return rom;
+}
+
+inline vector<byte> criar_rom_teste()
+{
+    // o tile 0 é opaco em todos os pixels, e os outros têm pixels opacos nas colunas 0 e 7
+    // de todas as linhas, então o sprite 0 sempre colide com o fundo, qualquer que seja o scroll
+    vector<byte> chr(0x2000);
+    uint32 semente = 1;
+    for (size_t i = 0; i < chr.size(); i++)
+    {
+        semente = semente * 1103515245 + 12345;
+        chr[i] = (semente >> 16) & 0xFF;
+        if (i < 16)
+        {
+            chr[i] = 0xFF;
+        }
+        else if ((i % 16) < 8)
+        {
+            chr[i] |= 0x81;
+        }
+    }
+
+    return criar_rom_nrom(programa_teste, 0xC0ED, 0xC11C, chr);
+}
+
+//! Estado observado pela cpu em um ciclo
+struct EstadoTeste
+{
+    uint32 ciclos;
+    uint16 pc;
+    byte a, x, y, sp, estado;
+    vector<byte> ram;
+
+    bool operator==(const EstadoTeste& outro) const
+    {
+        return ciclos == outro.ciclos && pc == outro.pc && a == outro.a && x == outro.x &&
+               y == outro.y && sp == outro.sp && estado == outro.estado && ram == outro.ram;
+    }
+
+    bool operator!=(const EstadoTeste& outro) const
+    {
+        return !(*this == outro);
+    }
+};
+
+inline EstadoTeste capturar_estado(Nes& nes)
+{
+    EstadoTeste estado;
+    estado.ciclos = nes.cpu.get_ciclos();
+    estado.pc = nes.cpu.pc;
+    estado.a = nes.cpu.a;
+    estado.x = nes.cpu.x;
+    estado.y = nes.cpu.y;
+    estado.sp = nes.cpu.sp;
+    estado.estado = nes.cpu.get_estado();
+
+    estado.ram.resize(0x800);
+    for (int i = 0; i < 0x800; i++)
+    {
+        estado.ram[i] = nes.memoria.ler(i);
+    }
+
+    return estado;
+}
+
+/*! Avança a execução que estiver atrasada até as duas chegarem ao mesmo ciclo. Os núcleos
+    podem executar várias instruções de uma vez, mas sempre param entre duas instruções,
+    então as duas execuções acabam se encontrando
+*/
+inline void alcancar(Nes& a, Nes& b)
+{
+    while (a.cpu.get_ciclos() != b.cpu.get_ciclos())
+    {
+        if (a.cpu.get_ciclos() < b.cpu.get_ciclos())
+        {
+            a.avancar();
+        }
+        else
+        {
+            b.avancar();
+        }
+    }
+}
+
+//! Hash FNV-1a do último frame completo
+inline uint64 calcular_hash_frame(Nes& nes)
+{
+    uint64 hash = 14695981039346656037ULL;
+    for (uint32 pixel : nes.ppu.get_textura())
+    {
+        hash = (hash ^ pixel) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*! Executa 300 frames nas duas instâncias, comparando o estado a cada 1000 ciclos
+    \param referencia Instância executada com o núcleo de referência
+    \param nes Instância comparada, com a mesma ROM carregada
+    \param comparar_frames Também compara cada novo frame completo das duas instâncias
+    \return false caso os estados sejam diferentes ou um erro seja lançado
+*/
+inline bool comparar_execucoes(Nes& referencia, Nes& nes, bool comparar_frames = false)
+{
+    uint64 frame_comparado = 0;
+    while (nes.ppu.get_frames_completos() < 300)
+    {
+        try
+        {
+            nes.executar_ciclos(1000);
+            alcancar(referencia, nes);
+        }
+        catch (const std::runtime_error&)
+        {
+            // o núcleo diferencial lança um erro quando o código nativo diverge do núcleo de blocos
+            return false;
+        }
+
+        if (capturar_estado(referencia) != capturar_estado(nes))
+        {
+            return false;
+        }
+
+        // 'get_textura' executa os pontos adiados, então a contagem de frames é lida depois
+        if (comparar_frames && nes.ppu.get_frames_completos() != frame_comparado)
+        {
+            if (calcular_hash_frame(referencia) != calcular_hash_frame(nes) ||
+                referencia.ppu.get_frames_completos() != nes.ppu.get_frames_completos())
+            {
+                return false;
+            }
+
+            frame_comparado = nes.ppu.get_frames_completos();
+        }
+    }
+
+    // o programa precisa ter chegado ao laço principal
+    return referencia.memoria.ler(0x10) != 0 && referencia.memoria.ler(0x0301) != 0;
+}
+/*! Executa as duas instâncias com as mesmas chamadas de 'executar_ciclos' e 'executar_frame',
+    sem alcançar uma à outra, até completar 300 frames. Os limites variam de 1 a 3000 ciclos
+    para que as chamadas terminem em todas as posições dos laços de espera e dos blocos
+    \return false caso os resultados das chamadas ou os estados sejam diferentes
+*/
+inline bool comparar_lotes(Nes& referencia, Nes& nes)
+{
+    uint32 semente = 1;
+    while (referencia.ppu.get_frames_completos() < 300)
+    {
+        semente = semente * 1103515245 + 12345;
+
+        NesExecucao resultado_referencia;
+        NesExecucao resultado;
+        if ((semente >> 16) % 64 == 0)
+        {
+            resultado_referencia = referencia.executar_frame();
+            resultado = nes.executar_frame();
+        }
+        else
+        {
+            const uint32 ciclos = 1 + (semente >> 16) % 3000;
+            resultado_referencia = referencia.executar_ciclos(ciclos);
+            resultado = nes.executar_ciclos(ciclos);
+        }
+
+        if (resultado.ciclos != resultado_referencia.ciclos ||
+            resultado.excedente != resultado_referencia.excedente ||
+            capturar_estado(referencia) != capturar_estado(nes))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "saida.hpp"
+#include "cores.hpp"
+
+using nesbrasa::nucleo::Simd;
+using nesbrasa::nucleo::is_simd_suportado;
+using nesbrasa::nucleo::cores::tabela_rgb_enfase;
+using nesbrasa::nucleo::saida::SaidaFormato;
+using nesbrasa::nucleo::saida::SaidaOpcoes;
+using namespace nesbrasa::nucleo::saida;
+using nesbrasa::tipos::byte;
+using nesbrasa::tipos::uint16;
+using nesbrasa::tipos::uint32;
+using std::vector;
+
+// bytes escritos depois do fim do destino, que não podem ser alterados pela conversão
+static const size_t GUARDA_TAMANHO = 64;
+static const byte GUARDA_VALOR = 0xCD;
+
+// a referência converte um pixel por vez, sem SIMD, para ser comparada com
+// cada conjunto de instruções escolhido por 'set_simd'
+
+static uint32 converter_pixel(uint32 rgb, SaidaFormato formato)
+{
+    const uint32 r = (rgb >> 16) & 0xFF;
+    const uint32 g = (rgb >> 8) & 0xFF;
+    const uint32 b = rgb & 0xFF;
+
+    switch (formato)
+    {
+        case SaidaFormato::RGBA8888: return 0xFF000000 | (b << 16) | (g << 8) | r;
+        case SaidaFormato::BGRA8888: return 0xFF000000 | rgb;
+        default: return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+}
+
+// BT.601 com faixa limitada
+static byte calcular_y(int r, int g, int b)
+{
+    return ((66*r + 129*g + 25*b + 128) >> 8) + 16;
+}
+
+static byte calcular_u(int r, int g, int b)
+{
+    return (-38*r - 74*g + 112*b + 128 + 128*256) >> 8;
+}
+
+static byte calcular_v(int r, int g, int b)
+{
+    return (112*r - 94*g - 18*b + 128 + 128*256) >> 8;
+}
+
+static bool testar_conversao(const vector<uint32>& textura, const vector<uint16>& indices,
+                             bool usar_indices, const SaidaOpcoes& opcoes, size_t passo)
+{
+    const int largura = get_largura(opcoes);
+    const int altura = get_altura(opcoes);
+    const int pixel_tamanho = get_pixel_tamanho(opcoes.formato);
+    const size_t tamanho = get_tamanho(opcoes, passo);
+
+    vector<byte> destino(tamanho + GUARDA_TAMANHO, GUARDA_VALOR);
+    if (usar_indices)
+    {
+        converter_textura_indices(indices.data(), destino.data(), opcoes, passo);
+    }
+    else
+    {
+        converter_textura(textura.data(), destino.data(), opcoes, passo);
+    }
+
+    for (size_t i = tamanho; i < destino.size(); i++)
+    {
+        if (destino[i] != GUARDA_VALOR)
+        {
+            return false;
+        }
+    }
+
+    // cor RGB do pixel (x, y) da imagem cortada e ampliada
+    auto buscar_rgb = [&](int x, int y) -> uint32
+    {
+        const int origem = (opcoes.corte_cima + y/opcoes.escala)*256 + opcoes.corte_esquerda + x/opcoes.escala;
+        return usar_indices ? tabela_rgb_enfase[indices[origem]] : textura[origem];
+    };
+
+    if (opcoes.formato != SaidaFormato::YUV420)
+    {
+        const size_t linha_passo = (passo != 0) ? passo : largura*pixel_tamanho;
+        for (int y = 0; y < altura; y++)
+        {
+            for (int x = 0; x < largura; x++)
+            {
+                uint32 pixel = 0;
+                std::memcpy(&pixel, &destino[y*linha_passo + x*pixel_tamanho], pixel_tamanho);
+                if (pixel != converter_pixel(buscar_rgb(x, y), opcoes.formato))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    for (int y = 0; y < altura; y++)
+    {
+        for (int x = 0; x < largura; x++)
+        {
+            const uint32 rgb = buscar_rgb(x, y);
+            if (destino[y*largura + x] != calcular_y((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF))
+            {
+                return false;
+            }
+        }
+    }
+
+    // U e V usam a média de cada bloco de 2x2 pixels, repetindo a última coluna
+    // e a última linha quando a largura ou a altura são ímpares
+    const int croma_largura = (largura + 1) / 2;
+    const int croma_altura = (altura + 1) / 2;
+    const byte* plano_u = &destino[largura*altura];
+    const byte* plano_v = plano_u + croma_largura*croma_altura;
+    for (int y = 0; y < croma_altura; y++)
+    {
+        for (int x = 0; x < croma_largura; x++)
+        {
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int bloco_y : { 2*y, std::min(2*y + 1, altura - 1) })
+            {
+                for (int bloco_x : { 2*x, std::min(2*x + 1, largura - 1) })
+                {
+                    const uint32 rgb = buscar_rgb(bloco_x, bloco_y);
+                    r += (rgb >> 16) & 0xFF;
+                    g += (rgb >> 8) & 0xFF;
+                    b += rgb & 0xFF;
+                }
+            }
+            r = (r + 2) / 4;
+            g = (g + 2) / 4;
+            b = (b + 2) / 4;
+
+            if (plano_u[y*croma_largura + x] != calcular_u(r, g, b) ||
+                plano_v[y*croma_largura + x] != calcular_v(r, g, b))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool testar_indices(const vector<uint16>& indices)
+{
+    // quantidades que não são múltiplas dos 16 pixels convertidos por vez com AVX2
+    for (size_t quantidade : { 1, 15, 16, 17, 100, 256*240 })
+    {
+        for (auto formato : { SaidaFormato::RGBA8888, SaidaFormato::BGRA8888, SaidaFormato::RGB565 })
+        {
+            const int pixel_tamanho = get_pixel_tamanho(formato);
+            vector<byte> destino(quantidade*pixel_tamanho + GUARDA_TAMANHO, GUARDA_VALOR);
+            converter_indices(indices.data(), quantidade, formato, destino.data());
+
+            for (size_t i = 0; i < quantidade; i++)
+            {
+                uint32 pixel = 0;
+                std::memcpy(&pixel, &destino[i*pixel_tamanho], pixel_tamanho);
+                if (pixel != converter_pixel(tabela_rgb_enfase[indices[i]], formato))
+                {
+                    return false;
+                }
+            }
+
+            for (size_t i = quantidade*pixel_tamanho; i < destino.size(); i++)
+            {
+                if (destino[i] != GUARDA_VALOR)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool testar_erros(const vector<uint32>& textura, const vector<uint16>& indices)
+{
+    const vector<SaidaOpcoes> invalidas = {
+        { SaidaFormato::RGBA8888, 0, 0, 0, 0, 0 },
+        { SaidaFormato::RGBA8888, 5, 0, 0, 0, 0 },
+        { SaidaFormato::RGBA8888, 1, 128, 128, 0, 0 },
+        { SaidaFormato::RGBA8888, 1, 0, 0, 120, 120 },
+        { SaidaFormato::RGB565, 1, -1, 0, 0, 0 },
+    };
+
+    vector<byte> destino(256*240*4);
+    for (const auto& opcoes : invalidas)
+    {
+        try
+        {
+            converter_textura(textura.data(), destino.data(), opcoes);
+            return false;
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+    }
+
+    // os índices não são convertidos diretamente para YUV420, que precisa das linhas vizinhas
+    try
+    {
+        converter_indices(indices.data(), indices.size(), SaidaFormato::YUV420, destino.data());
+        return false;
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    return true;
+}
+
+int main()
+{
+    // compara as conversões de cada conjunto de instruções suportado pelo
+    // processador com uma implementação de referência
+
+    std::mt19937 gerador(1);
+
+    vector<uint32> textura(256*240);
+    for (auto& pixel : textura)
+    {
+        pixel = gerador() & 0xFFFFFF;
+    }
+
+    vector<uint16> indices(256*240);
+    for (auto& indice : indices)
+    {
+        indice = gerador() & 0x1FF;
+    }
+
+    // esquerda, direita, cima e baixo, incluindo larguras e alturas ímpares e uma imagem de 1 pixel
+    const vector<std::array<int, 4>> cortes = {
+        { 0, 0, 0, 0 },
+        { 8, 8, 8, 8 },
+        { 1, 2, 3, 0 },
+        { 7, 0, 0, 5 },
+        { 0, 255, 0, 239 },
+    };
+
+    for (auto simd : { Simd::ESCALAR, Simd::SSE2, Simd::AVX2 })
+    {
+        if (!is_simd_suportado(simd))
+        {
+            continue;
+        }
+        set_simd(simd);
+
+        for (bool usar_indices : { false, true })
+        {
+            for (auto formato : { SaidaFormato::RGBA8888, SaidaFormato::BGRA8888,
+                                  SaidaFormato::RGB565, SaidaFormato::YUV420 })
+            {
+                for (int escala = 1; escala <= 4; escala++)
+                {
+                    for (const auto& corte : cortes)
+                    {
+                        const SaidaOpcoes opcoes = { formato, escala, corte[0], corte[1], corte[2], corte[3] };
+
+                        // linhas contíguas e linhas com bytes sobrando no fim, que o YUV420 ignora
+                        const size_t linha_tamanho = get_largura(opcoes) * get_pixel_tamanho(formato);
+                        for (size_t passo : { size_t(0), linha_tamanho + 12 })
+                        {
+                            if (!testar_conversao(textura, indices, usar_indices, opcoes, passo))
+                            {
+                                return EXIT_FAILURE;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!testar_indices(indices) || !testar_erros(textura, indices))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
\ No newline at end of file